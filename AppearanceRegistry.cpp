@@ -0,0 +1,59 @@
+#include "CommonImport.h"
+#include "AppearanceRegistry.h"
+
+// Key of a property that is not written
+constexpr long long UNUSED_PROPERTY = LLONG_MIN;
+
+size_t AppearanceKeyHash::operator()(const AppearanceKey& key) const {
+	size_t seed = 0;
+	for (long long val : key)
+		seed ^= hash<long long>()(val) + 0x9e3779b9 + (seed << 6) + (seed >> 2);
+
+	return seed;
+}
+
+AppearanceRegistry::AppearanceRegistry(void) {}
+
+AppearanceRegistry::~AppearanceRegistry(void) {
+	Clear();
+}
+
+const AppearanceKey AppearanceRegistry::GetKey(const Appearance& app) {
+	// Same tolerances as Quantity_Color::IsEqual and the former scalar comparisons
+	auto quantizeColor = [](const Quantity_Color& color, bool isOn, long long* key) {
+		double tol = Quantity_Color::Epsilon();
+		key[0] = isOn ? llround(color.Red() / tol) : UNUSED_PROPERTY;
+		key[1] = isOn ? llround(color.Green() / tol) : UNUSED_PROPERTY;
+		key[2] = isOn ? llround(color.Blue() / tol) : UNUSED_PROPERTY;
+	};
+	auto quantize = [](double val, bool isOn) {
+		return isOn ? llround(val / Precision::Confusion()) : UNUSED_PROPERTY;
+	};
+
+	AppearanceKey key;
+	quantizeColor(app.diffuseColor, app.isDiffuseOn, &key[0]);
+	quantizeColor(app.emissiveColor, app.isEmissiveOn, &key[3]);
+	quantizeColor(app.specularColor, app.isSpecularOn, &key[6]);
+	key[9] = quantize(app.shininess, app.isShininessOn);
+	key[10] = quantize(app.ambientIntensity, app.isAmbientIntensityOn);
+	key[11] = quantize(app.transparency, app.isTransparencyOn);
+
+	return key;
+}
+
+bool AppearanceRegistry::Register(const Appearance& app, int& appID) {
+	auto result = m_appIDMap.try_emplace(GetKey(app), (int)m_appearances.size());
+	appID = result.first->second;
+
+	if (!result.second)
+		return true;
+
+	m_appearances.push_back(app);
+
+	return false;
+}
+
+void AppearanceRegistry::Clear(void) {
+	m_appearances.clear();
+	m_appIDMap.clear();
+}
\ No newline at end of file
@@ -0,0 +1,48 @@
+#pragma once
+
+struct Appearance
+{
+	Quantity_Color diffuseColor;
+	Quantity_Color specularColor;
+	Quantity_Color emissiveColor;
+	double shininess = 0.0;
+	double ambientIntensity = 0.0;
+	double transparency = 0.0;
+
+	bool isDiffuseOn = false;
+	bool isEmissiveOn = false;
+	bool isSpecularOn = false;
+	bool isShininessOn = false;
+	bool isAmbientIntensityOn = false;
+	bool isTransparencyOn = false;
+};
+
+// Appearance snapped to the tolerance grid, unused properties left at a sentinel
+typedef array<long long, 12> AppearanceKey;
+
+struct AppearanceKeyHash {
+	size_t operator()(const AppearanceKey& key) const;
+};
+
+// Shared appearances looked up by their quantized properties.
+// IDs are handed out in registration order and stay stable for a writer run.
+class AppearanceRegistry {
+public:
+	AppearanceRegistry(void);
+	~AppearanceRegistry(void);
+
+	// Returns true if an equal appearance was already registered, appID is its ID either way
+	bool Register(const Appearance& app, int& appID);
+
+	const Appearance& GetAppearanceAt(int appID) const { return m_appearances[appID]; }
+	const int GetAppearanceSize(void) const { return (int)m_appearances.size(); }
+
+	void Clear(void);
+
+protected:
+	static const AppearanceKey GetKey(const Appearance& app);
+
+private:
+	vector<Appearance> m_appearances;
+	unordered_map<AppearanceKey, int, AppearanceKeyHash> m_appIDMap;
+};
\ No newline at end of file
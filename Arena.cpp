@@ -0,0 +1,60 @@
+#include "CommonImport.h"
+#include "Arena.h"
+
+// Size of the first block of each thread, grows geometrically afterwards
+constexpr size_t ARENA_INITIAL_SIZE = 1 << 20;
+
+// Source of arena generations, so a cached resource never matches a released or destroyed arena
+static atomic<uint64_t> s_nextGeneration(1);
+
+// Last resource used by this thread
+struct ThreadResourceCache {
+	uint64_t generation = 0;
+	pmr::monotonic_buffer_resource* resource = nullptr;
+};
+
+static thread_local ThreadResourceCache t_resourceCache;
+
+Arena::Arena(void)
+	: m_generation(s_nextGeneration++),
+	m_allocatedSize(0) {}
+
+Arena::~Arena(void) {}
+
+void Arena::Release(void) {
+	lock_guard<mutex> lock(m_mutex);
+
+	m_threadResources.clear();
+	m_generation = s_nextGeneration++;
+	m_allocatedSize = 0;
+}
+
+pmr::monotonic_buffer_resource* Arena::GetThreadResource(void) {
+	uint64_t generation = m_generation.load(memory_order_relaxed);
+	if (t_resourceCache.generation == generation)
+		return t_resourceCache.resource;
+
+	lock_guard<mutex> lock(m_mutex);
+
+	unique_ptr<pmr::monotonic_buffer_resource>& resource = m_threadResources[this_thread::get_id()];
+	if (!resource)
+		resource = make_unique<pmr::monotonic_buffer_resource>(ARENA_INITIAL_SIZE);
+
+	t_resourceCache.generation = generation;
+	t_resourceCache.resource = resource.get();
+
+	return resource.get();
+}
+
+void* Arena::do_allocate(size_t bytes, size_t alignment) {
+	m_allocatedSize.fetch_add(bytes, memory_order_relaxed);
+	return GetThreadResource()->allocate(bytes, alignment);
+}
+
+void Arena::do_deallocate(void*, size_t, size_t) {
+	// Monotonic: memory is only given back by Release()
+}
+
+bool Arena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+	return this == &other;
+}
\ No newline at end of file
@@ -0,0 +1,54 @@
+#pragma once
+
+#include <memory_resource>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+
+// Monotonic memory arena owning the Component / IShape / Mesh graph of a Model.
+// Objects are carved out of large contiguous blocks and never freed one at a time;
+// the whole arena is released at once when the Model is cleared or destroyed.
+// Each thread allocates from blocks of its own, so parallel passes do not contend.
+class Arena : public std::pmr::memory_resource {
+public:
+	Arena(void);
+	~Arena(void);
+
+	Arena(const Arena&) = delete;
+	Arena& operator=(const Arena&) = delete;
+
+	// Construct an object inside the arena
+	template<class T, class... Args>
+	T* New(Args&&... args) {
+		void* ptr = allocate(sizeof(T), alignof(T));
+		return ::new (ptr) T(std::forward<Args>(args)...);
+	}
+
+	// Run the destructor of an object created by New(); its memory is reclaimed by Release()
+	template<class T>
+	static void Delete(T* obj) {
+		if (obj)
+			obj->~T();
+	}
+
+	// Free every block at once, no other thread may allocate meanwhile
+	void Release(void);
+
+	size_t GetAllocatedSize(void) const { return m_allocatedSize.load(std::memory_order_relaxed); }
+
+protected:
+	void* do_allocate(size_t bytes, size_t alignment) override;
+	void do_deallocate(void*, size_t, size_t) override;
+	bool do_is_equal(const std::pmr::memory_resource& other) const noexcept override;
+
+	// Blocks of the calling thread, created on its first allocation
+	std::pmr::monotonic_buffer_resource* GetThreadResource(void);
+
+private:
+	std::mutex m_mutex;	// Guards the resource map, taken once per thread and release
+	std::unordered_map<std::thread::id, std::unique_ptr<std::pmr::monotonic_buffer_resource>> m_threadResources;
+	std::atomic<uint64_t> m_generation;	// Unique over all arenas, changed by Release
+	std::atomic<size_t> m_allocatedSize;
+};
\ No newline at end of file
@@ -5,21 +5,31 @@ using namespace std;
 
 #include <string>
 #include <vector>
+#include <array>
 #include <numeric>
 #include <sstream>
 #include <map>
 #include <unordered_map>
+#include <unordered_set>
+#include <queue>
+#include <atomic>
+#include <functional>
 #include <assert.h>
 #include <thread>
+#include <chrono>
 #include <filesystem>
 #include <codecvt>
+#include <memory_resource>
 #include "OCCLib.h"
 #include "OCCUtil.h"
 #include "StopWatch.h"
+#include "TraceRecorder.h"
 #include "NumTool.h"
 #include "StrTool.h"
 #include "InputOptions.h"
 #include "ShapeType.h"
+#include "Arena.h"
+#include "NameRegistry.h"
 #include "Model.h"
 
 constexpr auto PI = 3.14159265359;
\ No newline at end of file
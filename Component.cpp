@@ -3,27 +3,43 @@
 #include "IShape.h"
 
 
-Component::Component(const TopoDS_Shape& shape)
+Component::Component(const TopoDS_Shape& shape, pmr::memory_resource* resource)
 	: m_parentComponent(nullptr),
 	m_hasUniqueName(false),
 	m_shape(shape),
-	m_stepID(-1) {}
+	m_stepID(-1),
+	m_iShapes(resource),
+	m_faceSetSize(0),
+	m_hasBndBoxes{ false, false } {}
 
 Component::~Component(void) {
 	Clear();
 }
 
+void Component::SetName(const wstring& name) {
+	m_name = name;
+	UpdateIShapeNames();
+}
+
 void Component::AddIShape(IShape*& iShape) {
 	m_iShapes.push_back(iShape);
 	iShape->SetComponent(this);
+
+	if (iShape->IsFaceSet()) {
+		m_faceSetSize++;
+		iShape->SetName(m_name + L"_" + to_wstring(m_faceSetSize));
+	}
+
+	InvalidateBoundingBox();
 }
 
-void Component::Clean(void) {
-	CleanEmptyIShapes();
+bool Component::Clean(void) {
+	return CleanEmptyIShapes();
 }
 
-void Component::CleanEmptyIShapes(void) {
+bool Component::CleanEmptyIShapes(void) {
 	int iShapeSize = GetIShapeSize();
+	bool isRemoved = false;
 
 	for (int i = iShapeSize - 1; i >= 0; --i) {
 		IShape* iShape = GetIShapeAt(i);
@@ -35,9 +51,31 @@ void Component::CleanEmptyIShapes(void) {
 		// Remove empty IShapes after tessellation
 		if (iShape->IsEmpty()) {
 			m_iShapes.erase(m_iShapes.begin() + i);
-			delete iShape;
+			Arena::Delete(iShape);
+
+			InvalidateBoundingBox();
+			isRemoved = true;
 		}
 	}
+
+	// Renumber the remaining IShapes
+	if (isRemoved)
+		UpdateIShapeNames();
+
+	return isRemoved;
+}
+
+void Component::UpdateIShapeNames(void) {
+	wstring connector = L"_";	// Character connecting IShape name and order
+	m_faceSetSize = 0;
+
+	for (const auto& iShape : m_iShapes) {
+		if (iShape->IsSketchGeometry())
+			continue;
+
+		m_faceSetSize++;
+		iShape->SetName(m_name + connector + to_wstring(m_faceSetSize));
+	}
 }
 
 bool Component::IsRoot(void) const {
@@ -55,7 +93,10 @@ bool Component::IsEmpty(void) const {
 	return false;
 }
 
-const Bnd_Box Component::GetBoundingBox(bool sketch) const {
+const Bnd_Box& Component::GetBoundingBox(bool sketch) const {
+	if (m_hasBndBoxes[sketch])
+		return m_bndBoxes[sketch];
+
 	Bnd_Box bndBox;
 
 	// Add sub bounding boxes for iShapes
@@ -67,21 +108,51 @@ const Bnd_Box Component::GetBoundingBox(bool sketch) const {
 			&& isSketchGeometry)
 			continue;
 
-		const TopoDS_Shape& shape = iShape->GetShape();
-
-		const Bnd_Box& subBndBox = OCCUtil::ComputeBoundingBox(shape);
+		const Bnd_Box& subBndBox = iShape->GetBoundingBox();
 		bndBox.Add(subBndBox);
 	}
 
 	// Get the finite bounding box (mandatory)
-	bndBox = bndBox.FinitePart();
+	m_bndBoxes[sketch] = bndBox.FinitePart();
+	m_hasBndBoxes[sketch] = true;
+
+	return m_bndBoxes[sketch];
+}
+
+void Component::InvalidateBoundingBox(void) {
+	m_hasBndBoxes[false] = false;
+	m_hasBndBoxes[true] = false;
+}
+
+void Component::ComputeOrientedBoundingBox(void) {
+	m_obb.SetVoid();
+
+	vector<IShape*> iShapes;
+	for (const auto& iShape : m_iShapes) {
+		if (iShape->IsFaceSet()
+			&& !iShape->GetOrientedBoundingBox().IsVoid())
+			iShapes.push_back(iShape);
+	}
+
+	// A single IShape box is already the tightest, more are rebuilt from all of their mesh nodes
+	if (iShapes.size() == 1) {
+		m_obb = iShapes[0]->GetOrientedBoundingBox();
+		return;
+	}
+
+	vector<const Mesh*> meshes;
+	for (const auto& iShape : iShapes) {
+		for (int i = 0; i < iShape->GetMeshSize(); ++i)
+			meshes.push_back(iShape->GetMeshAt(i));
+	}
 
-	return bndBox;
+	IShape::BuildOrientedBoundingBox(meshes, m_obb);
 }
 
 void Component::Clear(void) {
+	// IShapes live in the model arena
 	for (auto iShape : m_iShapes) {
-		delete iShape;
+		Arena::Delete(iShape);
 	}
 	m_iShapes.clear();
 }
\ No newline at end of file
@@ -4,10 +4,10 @@ class IShape;
 
 class Component {
 public:
-	Component(const TopoDS_Shape& shape);
+	Component(const TopoDS_Shape& shape, pmr::memory_resource* resource = pmr::get_default_resource());
 	~Component(void);
 
-	void SetName(const wstring& name) { m_name = name; }
+	void SetName(const wstring& name);
 	void AddIShape(IShape*& iShape);
 	const wstring& GetName(void) const { return m_name; }
 	const wstring& GetUniqueName(void) const { return m_uniqueName; }
@@ -15,17 +15,24 @@ public:
 	Component* GetParentComponent(void) const { return m_parentComponent; }
 	IShape* GetIShapeAt(const int index) const { return m_iShapes[index]; }
 	const int GetIShapeSize(void) const { return (int)m_iShapes.size(); }
-	const Bnd_Box GetBoundingBox(bool sketch) const;
+	const Bnd_Box& GetBoundingBox(bool sketch) const;
+	void InvalidateBoundingBox(void);
+
+	// Oriented box of the face set IShapes
+	const Bnd_OBB& GetOrientedBoundingBox(void) const { return m_obb; }
+	void ComputeOrientedBoundingBox(void);
 
 	bool HasUniqueName(void) const { return m_hasUniqueName; }
 	bool IsRoot(void) const;
 	bool IsEmpty(void) const;
 
-	void Clean(void);
+	// Returns true if IShapes were removed
+	bool Clean(void);
 
 protected:
 	void Clear(void);
-	void CleanEmptyIShapes(void);
+	bool CleanEmptyIShapes(void);
+	void UpdateIShapeNames(void);
 	void ClearIShapes(void) { m_iShapes.clear(); }
 
 private:
@@ -35,5 +42,11 @@ private:
 	bool m_hasUniqueName;
 	int m_stepID;
 	Component* m_parentComponent;
-	vector<IShape*> m_iShapes;
+	pmr::vector<IShape*> m_iShapes;
+	int m_faceSetSize;	// Face set IShapes, numbered in their names
+
+	// Union of the IShape boxes without and with sketch geometry
+	mutable Bnd_Box m_bndBoxes[2];
+	mutable bool m_hasBndBoxes[2];
+	Bnd_OBB m_obb;
 };
\ No newline at end of file
@@ -0,0 +1,261 @@
+#include "CommonImport.h"
+#include "FolderWatcher.h"
+#include <fstream>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <poll.h>
+#include <unistd.h>
+#endif
+
+namespace fs = std::filesystem;
+
+// Quiet period after the last event of a file, writers may close a file more than once
+constexpr chrono::milliseconds DEBOUNCE_TIME(500);
+
+// Longest wait for events, bounds the delay of Stop and of the debounce
+constexpr int POLL_TIMEOUT_MS = 100;
+
+// Files waiting for a worker, the watcher blocks beyond this
+constexpr size_t QUEUE_CAPACITY = 64;
+
+// FNV-1a over 64 bits
+constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+constexpr uint64_t FNV_PRIME = 1099511628211ULL;
+
+FolderWatcher::FolderWatcher(const fs::path& directory, int jobCount, const Converter& converter)
+	: m_directory(directory),
+	m_jobCount(max(1, jobCount)),
+	m_converter(converter),
+	m_isStopped(false),
+	m_convertedCount(0),
+	m_failedCount(0),
+	m_skippedCount(0) {}
+
+FolderWatcher::~FolderWatcher(void) {}
+
+bool FolderWatcher::Run(void) {
+#ifdef __linux__
+	int fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	if (fd < 0) {
+		cout << "Cannot initialize inotify" << endl;
+		return false;
+	}
+
+	// Closed after writing, or renamed into the directory by writers that stage elsewhere
+	int wd = inotify_add_watch(fd, m_directory.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO | IN_DELETE_SELF | IN_MOVE_SELF);
+	if (wd < 0) {
+		cout << "Cannot watch directory: " << m_directory.string() << endl;
+		close(fd);
+		return false;
+	}
+
+	m_isStopped = false;
+
+	vector<thread> workers;
+	for (int i = 0; i < m_jobCount; ++i)
+		workers.emplace_back(&FolderWatcher::Work, this);
+
+	cout << "Watching " << m_directory.string() << " with " << m_jobCount << " conversion job(s)" << endl;
+
+	// Files written before the watch started
+	ScanDirectory();
+
+	alignas(inotify_event) char buffer[64 * 1024];
+	while (!m_isStopped) {
+		pollfd pfd = { fd, POLLIN, 0 };
+		int ready = poll(&pfd, 1, POLL_TIMEOUT_MS);
+
+		if (ready > 0) {
+			ssize_t size = 0;
+			while ((size = read(fd, buffer, sizeof(buffer))) > 0) {
+				for (char* ptr = buffer; ptr < buffer + size; ) {
+					const inotify_event* event = reinterpret_cast<const inotify_event*>(ptr);
+					ptr += sizeof(inotify_event) + event->len;
+
+					if (event->mask & IN_Q_OVERFLOW) {
+						// Events were dropped, the hashes tell which files actually changed
+						ScanDirectory();
+					} else if (event->mask & (IN_DELETE_SELF | IN_MOVE_SELF | IN_IGNORED)) {
+						cout << "Watched directory is gone: " << m_directory.string() << endl;
+						m_isStopped = true;
+					} else if (event->len > 0
+							   && !(event->mask & IN_ISDIR)) {
+						fs::path filePath = m_directory / event->name;
+						if (IsStepFile(filePath))
+							Schedule(filePath);
+					}
+				}
+			}
+		} else if (ready < 0
+				   && errno != EINTR)
+			break;
+
+		FlushScheduled();
+	}
+
+	inotify_rm_watch(fd, wd);
+	close(fd);
+
+	// Workers finish the files being converted and drop the rest of the queue
+	m_isStopped = true;
+	m_queueCondition.notify_all();
+	m_spaceCondition.notify_all();
+
+	for (auto& worker : workers)
+		worker.join();
+
+	cout << "Watch stopped: " << m_convertedCount << " converted, " << m_failedCount << " failed, " << m_skippedCount << " unchanged" << endl;
+
+	return true;
+#else
+	cout << "Watch mode needs inotify and is only available on Linux" << endl;
+	return false;
+#endif
+}
+
+bool FolderWatcher::IsStepFile(const fs::path& filePath) {
+	string extension = filePath.extension().string();
+	transform(extension.begin(), extension.end(), extension.begin(), [](char c) { return (char)tolower(c); });
+
+	return extension == ".stp"
+		|| extension == ".step"
+		|| extension == ".p21";
+}
+
+uint64_t FolderWatcher::HashFile(const fs::path& filePath) {
+	ifstream ifs(filePath, ios::binary);
+	if (!ifs.is_open())
+		return 0;
+
+	uint64_t hash = FNV_OFFSET_BASIS;
+	vector<char> buffer(1 << 20);
+
+	while (ifs.read(buffer.data(), buffer.size())
+		   || ifs.gcount() > 0) {
+		streamsize size = ifs.gcount();
+		for (streamsize i = 0; i < size; ++i) {
+			hash ^= (uint8_t)buffer[i];
+			hash *= FNV_PRIME;
+		}
+	}
+
+	return hash;
+}
+
+void FolderWatcher::ScanDirectory(void) {
+	error_code ec;
+	for (const auto& entry : fs::directory_iterator(m_directory, ec)) {
+		if (entry.is_regular_file(ec)
+			&& IsStepFile(entry.path()))
+			Schedule(entry.path());
+	}
+}
+
+void FolderWatcher::Schedule(const fs::path& filePath) {
+	m_scheduledMap[filePath] = chrono::steady_clock::now() + DEBOUNCE_TIME;
+}
+
+void FolderWatcher::FlushScheduled(void) {
+	chrono::steady_clock::time_point now = chrono::steady_clock::now();
+
+	for (auto it = m_scheduledMap.begin(); it != m_scheduledMap.end() && !m_isStopped; ) {
+		if (it->second > now) {
+			++it;
+			continue;
+		}
+
+		fs::path filePath = it->first;
+
+		// A file still queued or converting is looked at again once it is done
+		{
+			lock_guard<mutex> lock(m_mutex);
+			if (m_busyFiles.count(filePath) > 0) {
+				it->second = now + DEBOUNCE_TIME;
+				++it;
+				continue;
+			}
+		}
+
+		it = m_scheduledMap.erase(it);
+
+		error_code ec;
+		if (!fs::is_regular_file(filePath, ec))
+			continue;
+
+		// Vaults rewrite files with the same content, those are not converted again
+		uint64_t hash = HashFile(filePath);
+		{
+			lock_guard<mutex> lock(m_mutex);
+			auto hashIt = m_hashMap.find(filePath);
+			if (hashIt != m_hashMap.end()
+				&& hashIt->second == hash) {
+				m_skippedCount++;
+				continue;
+			}
+		}
+
+		Enqueue(filePath, hash);
+	}
+}
+
+bool FolderWatcher::Enqueue(const fs::path& filePath, uint64_t hash) {
+	unique_lock<mutex> lock(m_mutex);
+	m_spaceCondition.wait(lock, [this] {
+		return m_queue.size() < QUEUE_CAPACITY
+			|| m_isStopped;
+	});
+
+	if (m_isStopped)
+		return false;
+
+	m_queue.push(make_pair(filePath, hash));
+	m_busyFiles.insert(filePath);
+	m_queueCondition.notify_one();
+
+	return true;
+}
+
+void FolderWatcher::Work(void) {
+	while (true) {
+		fs::path filePath;
+		uint64_t hash = 0;
+		{
+			unique_lock<mutex> lock(m_mutex);
+			m_queueCondition.wait(lock, [this] {
+				return !m_queue.empty()
+					|| m_isStopped;
+			});
+
+			if (m_isStopped)
+				return;
+
+			filePath = m_queue.front().first;
+			hash = m_queue.front().second;
+			m_queue.pop();
+			m_spaceCondition.notify_one();
+		}
+
+		cout << "Converting " << filePath.string() << endl;
+
+		bool isDone = false;
+		try {
+			isDone = m_converter(filePath);
+		} catch (...) {
+			// A broken file must not end the watch
+		}
+
+		lock_guard<mutex> lock(m_mutex);
+		m_busyFiles.erase(filePath);
+
+		// A failed file is converted again on its next event, even with the same content
+		if (isDone) {
+			m_hashMap[filePath] = hash;
+			m_convertedCount++;
+		} else {
+			m_hashMap.erase(filePath);
+			m_failedCount++;
+			cout << "Conversion has failed: " << filePath.string() << endl;
+		}
+	}
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <mutex>
+#include <condition_variable>
+#include <set>
+
+// Watches a directory for STEP files closed after writing or moved in, and converts them on a bounded
+// number of worker threads. Events are debounced per file and unchanged contents are skipped by hash.
+class FolderWatcher {
+public:
+	// Converts one file, false on failure
+	typedef function<bool(const filesystem::path& filePath)> Converter;
+
+	FolderWatcher(const filesystem::path& directory, int jobCount, const Converter& converter);
+	~FolderWatcher(void);
+
+	// Convert the STEP files already in the directory, then watch it until Stop. False if it cannot be watched.
+	bool Run(void);
+
+	// Safe from a signal handler, the files being converted are finished
+	void Stop(void) { m_isStopped = true; }
+
+	static bool IsStepFile(const filesystem::path& filePath);
+	static uint64_t HashFile(const filesystem::path& filePath);
+
+protected:
+	void ScanDirectory(void);
+
+	// Restart the quiet period of a file
+	void Schedule(const filesystem::path& filePath);
+	void FlushScheduled(void);
+
+	// Wait for room in the queue, false once stopped. The hash is recorded once the conversion succeeds.
+	bool Enqueue(const filesystem::path& filePath, uint64_t hash);
+	void Work(void);
+
+private:
+	filesystem::path m_directory;
+	int m_jobCount;
+	Converter m_converter;
+	atomic<bool> m_isStopped;
+
+	// Watcher thread only
+	map<filesystem::path, chrono::steady_clock::time_point> m_scheduledMap;	// File to the end of its quiet period
+
+	// Shared with the workers
+	mutex m_mutex;
+	condition_variable m_queueCondition;	// A file was queued or the watcher stopped
+	condition_variable m_spaceCondition;	// A file left the queue
+	queue<pair<filesystem::path, uint64_t>> m_queue;	// File and its content hash
+	map<filesystem::path, uint64_t> m_hashMap;	// Content hash of the last successful conversion of each file
+	set<filesystem::path> m_busyFiles;		// Queued or being converted
+
+	int m_convertedCount;
+	int m_failedCount;
+	int m_skippedCount;
+};
\ No newline at end of file
@@ -4,13 +4,22 @@
 #include "Mesh.h"
 
 
-IShape::IShape(const TopoDS_Shape& shape)
+IShape::IShape(const TopoDS_Shape& shape, pmr::memory_resource* resource)
 	: m_shape(shape),
 	m_isTessellated(false),
 	m_isFaceSet(false),
 	m_component(nullptr),
 	m_globalIndex(0),
-	m_stepID(-1) {
+	m_stepID(-1),
+	m_hasBndBox(false),
+	m_isMeshBndBox(false),
+	m_meshList(resource),
+	m_lodList(resource),
+	m_solidPropertiesList(resource),
+	m_solidObbList(resource),
+	m_colorList(resource),
+	m_shapeIDcolorMap(resource),
+	m_faceStepIDMap(resource) {
 	// Check if the shape is a face set
 	if (OCCUtil::HasFace(m_shape)) {
 		m_isFaceSet = true;
@@ -28,6 +37,117 @@ const Quantity_ColorRGBA& IShape::GetColor(const TopoDS_Shape& shape) const {
 	return color;
 }
 
+const int IShape::GetFaceStepID(const TopoDS_Shape& face) const {
+	auto it = m_faceStepIDMap.find(face.TShape().get());
+	if (it == m_faceStepIDMap.end())
+		return -1;
+
+	return it->second;
+}
+
+void IShape::AddMesh(Mesh*& mesh) {
+	m_meshList.push_back(mesh);
+
+	// A box of the B-rep stays valid when meshes are added
+	if (m_isMeshBndBox)
+		InvalidateBoundingBox();
+}
+
+void IShape::AddLod(const vector<Mesh*>& meshes) {
+	m_lodList.emplace_back(meshes.begin(), meshes.end());
+}
+
+const Bnd_Box& IShape::GetBoundingBox(void) const {
+	if (!m_hasBndBox) {
+		m_bndBox = OCCUtil::ComputeBoundingBox(m_shape);
+		m_hasBndBox = true;
+	}
+
+	return m_bndBox;
+}
+
+void IShape::ComputeBoundingBox(bool fromMesh) {
+	// Nodes are only available after tessellation
+	if (!fromMesh
+		|| m_meshList.empty()) {
+		m_bndBox = OCCUtil::ComputeBoundingBox(m_shape);
+		m_hasBndBox = true;
+		m_isMeshBndBox = false;
+		return;
+	}
+
+	vector<Bnd_Box> meshBndBoxes(m_meshList.size());
+	OSD_Parallel::For(0, (int)m_meshList.size(), [this, &meshBndBoxes](int i) {
+		const Mesh* mesh = m_meshList[i];
+
+		for (int j = 0; j < mesh->GetCoordinateSize(); ++j)
+			meshBndBoxes[i].Add(gp_Pnt(mesh->GetCoordinateAt(j)));
+	});
+
+	m_bndBox.SetVoid();
+	for (const auto& meshBndBox : meshBndBoxes)
+		m_bndBox.Add(meshBndBox);
+
+	m_hasBndBox = true;
+	m_isMeshBndBox = true;
+}
+
+void IShape::InvalidateBoundingBox(void) {
+	m_hasBndBox = false;
+	m_isMeshBndBox = false;
+
+	if (m_component)
+		m_component->InvalidateBoundingBox();
+}
+
+void IShape::ComputeOrientedBoundingBox(void) {
+	m_obb.SetVoid();
+	m_solidObbList.clear();
+
+	vector<const Mesh*> meshes(m_meshList.begin(), m_meshList.end());
+	BuildOrientedBoundingBox(meshes, m_obb);
+
+	// Face meshes of each solid in explorer order, a face shared by two solids counts for both
+	TopTools_DataMapOfShapeInteger meshIndexes;
+	for (int i = 0; i < (int)m_meshList.size(); ++i)
+		meshIndexes.Bind(m_meshList[i]->GetShape(), i);
+
+	TopExp_Explorer ExpSolid;
+	for (ExpSolid.Init(m_shape, TopAbs_SOLID); ExpSolid.More(); ExpSolid.Next()) {
+		vector<const Mesh*> solidMeshes;
+		TopExp_Explorer ExpFace;
+		for (ExpFace.Init(ExpSolid.Current(), TopAbs_FACE); ExpFace.More(); ExpFace.Next()) {
+			if (meshIndexes.IsBound(ExpFace.Current()))
+				solidMeshes.push_back(m_meshList[meshIndexes.Find(ExpFace.Current())]);
+		}
+
+		Bnd_OBB solidObb;
+		BuildOrientedBoundingBox(solidMeshes, solidObb);
+		m_solidObbList.push_back(solidObb);
+	}
+}
+
+void IShape::BuildOrientedBoundingBox(const vector<const Mesh*>& meshes, Bnd_OBB& obb) {
+	obb.SetVoid();
+
+	int nodeCount = 0;
+	for (const auto& mesh : meshes)
+		nodeCount += mesh->GetCoordinateSize();
+
+	if (nodeCount == 0)
+		return;
+
+	TColgp_Array1OfPnt nodes(1, nodeCount);
+	int index = 1;
+	for (const auto& mesh : meshes) {
+		for (int i = 0; i < mesh->GetCoordinateSize(); ++i)
+			nodes.SetValue(index++, gp_Pnt(mesh->GetCoordinateAt(i)));
+	}
+
+	// DiTO: extremal nodes along a few fixed directions give the axes, linear in the node count
+	obb.ReBuild(nodes);
+}
+
 bool IShape::IsEmpty(void) const {
 	if (GetMeshSize() == 0)
 		return true;
@@ -35,6 +155,18 @@ bool IShape::IsEmpty(void) const {
 	return false;
 }
 
+bool IShape::HasNormals(void) const {
+	bool hasNormals = false;
+	for (const auto& mesh : m_meshList) {
+		if (mesh->GetNormalSize() > 0)
+			hasNormals = true;
+		else if (mesh->GetFaceIndexSize() > 0)
+			return false;
+	}
+
+	return hasNormals;
+}
+
 wstring IShape::GetUniqueName(void) const {
 	// Get the closest component with a unique name
 	Component* comp = GetComponent();
@@ -50,10 +182,21 @@ wstring IShape::GetUniqueName(void) const {
 }
 
 void IShape::Clear(void) {
+	// Meshes live in the model arena
 	for (auto mesh : m_meshList)
-		delete mesh;
+		Arena::Delete(mesh);
 
 	m_meshList.clear();
+
+	for (const auto& lod : m_lodList) {
+		for (auto mesh : lod)
+			Arena::Delete(mesh);
+	}
+
+	m_lodList.clear();
+	m_solidPropertiesList.clear();
+	m_solidObbList.clear();
 	m_colorList.clear();
 	m_shapeIDcolorMap.clear();
+	m_faceStepIDMap.clear();
 }
\ No newline at end of file
@@ -1,20 +1,29 @@
 #pragma once
 
+#include "MassProperties.h"
+
 class Component;
 class Mesh;
 
 class IShape {
 public:
-	IShape(const TopoDS_Shape& shape);
+	IShape(const TopoDS_Shape& shape, pmr::memory_resource* resource = pmr::get_default_resource());
 	~IShape(void);
 
 	void SetName(const wstring& name) { m_name = name; }
 	void SetComponent(Component* comp) { m_component = comp; }
 	void SetGlobalIndex(int globalIndex) { m_globalIndex = globalIndex; }
 	void SetTessellated(bool isTessellated) { m_isTessellated = isTessellated; }
-	void AddMesh(Mesh*& mesh) { m_meshList.push_back(mesh); }
+	void AddMesh(Mesh*& mesh);
 	void SetVolume(double& volume) { m_volume = volume; }
 	const double GetVolume() const { return m_volume; }
+
+	// Sum over the solids and the faces outside of them, with the breakdown per solid in explorer order
+	void SetMassProperties(const MassProperties& massProperties) { m_massProperties = massProperties; }
+	void AddSolidProperties(const MassProperties& solidProperties) { m_solidPropertiesList.push_back(solidProperties); }
+	const MassProperties& GetMassProperties(void) const { return m_massProperties; }
+	const MassProperties& GetSolidPropertiesAt(int index) const { return m_solidPropertiesList[index]; }
+	const int GetSolidPropertiesSize(void) const { return (int)m_solidPropertiesList.size(); }
 	const wstring& GetName(void) const { return m_name; }
 	Component* GetComponent(void) const { return m_component; }
 	const TopoDS_Shape& GetShape(void) const { return m_shape; }
@@ -25,6 +34,11 @@ public:
 	const int GetGlobalIndex(void) const { return m_globalIndex; }
 
 	const int GetMeshSize(void) const { return (int)m_meshList.size(); }
+
+	// Simplified levels of detail, each with one mesh per mesh of the full level
+	void AddLod(const vector<Mesh*>& meshes);
+	Mesh* GetLodMeshAt(int level, int index) const { return m_lodList[level][index]; }
+	const int GetLodSize(void) const { return (int)m_lodList.size(); }
 	bool IsTessellated(void) const { return m_isTessellated; }
 
 	bool IsFaceSet(void) const { return m_isFaceSet; }
@@ -32,12 +46,31 @@ public:
 
 	bool IsEmpty(void) const;
 
+	// Every mesh with triangles has normals, so the normal indexes line up with the triangles
+	bool HasNormals(void) const;
+
+	// Bounding box cached until the shape or its meshes change, computed from the B-rep if missing
+	const Bnd_Box& GetBoundingBox(void) const;
+	void ComputeBoundingBox(bool fromMesh);
+	void InvalidateBoundingBox(void);
+
+	// Oriented box of the mesh nodes, void before tessellation, with one box per solid in explorer order
+	const Bnd_OBB& GetOrientedBoundingBox(void) const { return m_obb; }
+	const Bnd_OBB& GetSolidObbAt(int index) const { return m_solidObbList[index]; }
+	const int GetSolidObbSize(void) const { return (int)m_solidObbList.size(); }
+	void ComputeOrientedBoundingBox(void);
+	static void BuildOrientedBoundingBox(const vector<const Mesh*>& meshes, Bnd_OBB& obb);
+
 	// SFA-specific
 	wstring GetUniqueName(void) const;
 
 	void SetStepID(int stepID) { m_stepID = stepID; }
 	const int GetStepID(void) const { return m_stepID; }
 
+	// STEP entity numbers of the faces, keyed by TShape
+	void SetFaceStepID(const TopoDS_Shape& face, int stepID) { m_faceStepIDMap[face.TShape().get()] = stepID; }
+	const int GetFaceStepID(const TopoDS_Shape& face) const;
+
 
 protected:
 	void Clear(void);
@@ -51,10 +84,20 @@ private:
 	bool m_isTessellated;
 	bool m_isFaceSet;
 	double m_volume;
+	MassProperties m_massProperties;
 
 	Component* m_component;
 
-	vector<Mesh*> m_meshList;
-	vector<Quantity_ColorRGBA> m_colorList;
-	unordered_map<int, Quantity_ColorRGBA> m_shapeIDcolorMap;
+	mutable Bnd_Box m_bndBox;
+	mutable bool m_hasBndBox;
+	bool m_isMeshBndBox;	// The cached box bounds the mesh nodes
+	Bnd_OBB m_obb;
+
+	pmr::vector<Mesh*> m_meshList;
+	pmr::vector<pmr::vector<Mesh*>> m_lodList;
+	pmr::vector<MassProperties> m_solidPropertiesList;
+	pmr::vector<Bnd_OBB> m_solidObbList;
+	pmr::vector<Quantity_ColorRGBA> m_colorList;
+	pmr::unordered_map<int, Quantity_ColorRGBA> m_shapeIDcolorMap;
+	pmr::unordered_map<const TopoDS_TShape*, int> m_faceStepIDMap;
 };
\ No newline at end of file
@@ -0,0 +1,52 @@
+#include "CommonImport.h"
+#include "IndexBuffer.h"
+
+IndexBuffer::IndexBuffer(pmr::memory_resource* resource)
+	: m_isWide(false),
+	m_narrowIndexes(resource),
+	m_wideIndexes(resource) {}
+
+IndexBuffer::~IndexBuffer(void) {}
+
+void IndexBuffer::Reserve(int size, int maxIndex) {
+	if (!m_isWide
+		&& maxIndex > UINT16_MAX)
+		Widen();
+
+	if (m_isWide)
+		m_wideIndexes.reserve(size);
+	else
+		m_narrowIndexes.reserve(size);
+}
+
+void IndexBuffer::Resize(int size, bool isWide) {
+	Clear();
+	m_isWide = isWide;
+
+	if (m_isWide)
+		m_wideIndexes.resize(size);
+	else
+		m_narrowIndexes.resize(size);
+}
+
+void IndexBuffer::Swap(IndexBuffer& other) {
+	swap(m_isWide, other.m_isWide);
+	m_narrowIndexes.swap(other.m_narrowIndexes);
+	m_wideIndexes.swap(other.m_wideIndexes);
+}
+
+void IndexBuffer::Clear(void) {
+	m_isWide = false;
+	m_narrowIndexes.clear();
+	m_wideIndexes.clear();
+}
+
+void IndexBuffer::Widen(void) {
+	// Happens at most once, the narrow indexes are copied over
+	m_wideIndexes.reserve(max(m_narrowIndexes.capacity(), m_narrowIndexes.size() + 1));
+	m_wideIndexes.assign(m_narrowIndexes.begin(), m_narrowIndexes.end());
+
+	m_narrowIndexes.clear();
+	m_narrowIndexes.shrink_to_fit();
+	m_isWide = true;
+}
\ No newline at end of file
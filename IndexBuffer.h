@@ -0,0 +1,89 @@
+#pragma once
+
+// 1-based node indexes, stored in 16 bits while every index fits and in 32 bits once one does not
+class IndexBuffer {
+public:
+	IndexBuffer(pmr::memory_resource* resource = pmr::get_default_resource());
+	~IndexBuffer(void);
+
+	// Room for size indexes up to maxIndex, which also fixes the width ahead
+	void Reserve(int size, int maxIndex);
+
+	// Size indexes of the given width, to be read into GetData
+	void Resize(int size, bool isWide);
+
+	void Add(int index) {
+		if (m_isWide)
+			m_wideIndexes.push_back((uint32_t)index);
+		else if (index > UINT16_MAX) {
+			Widen();
+			m_wideIndexes.push_back((uint32_t)index);
+		} else
+			m_narrowIndexes.push_back((uint16_t)index);
+	}
+
+	// Replace an index, as large as the largest one already stored
+	void Set(int position, int index) {
+		if (m_isWide)
+			m_wideIndexes[position] = (uint32_t)index;
+		else
+			m_narrowIndexes[position] = (uint16_t)index;
+	}
+
+	int operator[](int position) const {
+		return m_isWide ? (int)m_wideIndexes[position] : (int)m_narrowIndexes[position];
+	}
+
+	int GetSize(void) const { return m_isWide ? (int)m_wideIndexes.size() : (int)m_narrowIndexes.size(); }
+	bool IsWide(void) const { return m_isWide; }
+	pmr::memory_resource* GetResource(void) const { return m_narrowIndexes.get_allocator().resource(); }
+	int GetWidth(void) const { return m_isWide ? (int)sizeof(uint32_t) : (int)sizeof(uint16_t); }
+
+	// Raw indexes of GetWidth bytes each, for the binary writers
+	const void* GetData(void) const { return m_isWide ? (const void*)m_wideIndexes.data() : (const void*)m_narrowIndexes.data(); }
+	void* GetData(void) { return m_isWide ? (void*)m_wideIndexes.data() : (void*)m_narrowIndexes.data(); }
+
+	// Bytes reserved, for the memory report
+	size_t GetBytes(void) const { return m_narrowIndexes.capacity() * sizeof(uint16_t) + m_wideIndexes.capacity() * sizeof(uint32_t); }
+
+	void Swap(IndexBuffer& other);
+	void Clear(void);
+
+protected:
+	void Widen(void);
+
+private:
+	bool m_isWide;
+	pmr::vector<uint16_t> m_narrowIndexes;
+	pmr::vector<uint32_t> m_wideIndexes;
+};
+
+// Consecutive indexes of a buffer, the nodes of one triangle or one edge polyline
+class IndexRange {
+public:
+	class Iterator {
+	public:
+		Iterator(const IndexBuffer* buffer, int position) : m_buffer(buffer), m_position(position) {}
+
+		int operator*(void) const { return (*m_buffer)[m_position]; }
+		Iterator& operator++(void) { ++m_position; return *this; }
+		bool operator!=(const Iterator& other) const { return m_position != other.m_position; }
+
+	private:
+		const IndexBuffer* m_buffer;
+		int m_position;
+	};
+
+	IndexRange(const IndexBuffer& buffer, int begin, int end) : m_buffer(&buffer), m_begin(begin), m_end(end) {}
+
+	int operator[](int index) const { return (*m_buffer)[m_begin + index]; }
+	size_t size(void) const { return (size_t)(m_end - m_begin); }
+
+	Iterator begin(void) const { return Iterator(m_buffer, m_begin); }
+	Iterator end(void) const { return Iterator(m_buffer, m_end); }
+
+private:
+	const IndexBuffer* m_buffer;
+	int m_begin;
+	int m_end;
+};
\ No newline at end of file
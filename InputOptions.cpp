@@ -10,7 +10,30 @@ InputOptions::InputOptions()
 	m_sketch(true),
 	m_html(true),
 	m_quality(10.0),
-	m_SFA(true) {}
+	m_SFA(true),
+	m_faceReport(0),
+	m_meshBounds(false),
+	m_normals(false),
+	m_creaseAngle(0.2),
+	m_vertexCache(0),
+	m_progress(false),
+	m_transferThreads(1),
+	m_scan(false),
+	m_watch(false),
+	m_watchJobs(1),
+	m_lodLevels(0),
+	m_adaptiveDeflection(false),
+	m_triangleBudget(0),
+	m_maxTriangles(0),
+	m_maxFaceTriangles(0),
+	m_timeLimit(0.0),
+	m_faceTimeLimit(0.0),
+	m_massTolerance(0.0),
+	m_meshCache(L""),
+	m_trace(L""),
+	m_memReport(false),
+	m_shardIndex(0),
+	m_shardCount(1) {}
 
 InputOptions::~InputOptions() {}
 
@@ -28,4 +51,121 @@ const wstring InputOptions::GetOutput(void) const {
 const wstring InputOptions::GetOutputJson(void) const {
 	wstring output = m_output;
 	return output;
+}
+
+bool InputOptions::SetOption(const wstring& option, const wstring& value) {
+	if (option == L"--input") {
+		SetInput(value);
+	} else if (option == L"--output") {
+		SetOutput(value);
+	} else if (option == L"--face-report") {
+		SetFaceReport(max(0, stoi(value)));
+	} else if (option == L"--bounds") {
+		if (value != L"brep"
+			&& value != L"mesh") {
+			wcout << "Invalid bounds, expected brep or mesh: " << value << endl;
+			return false;
+		}
+		SetMeshBounds(value == L"mesh");
+	} else if (option == L"--normals") {
+		if (value != L"on"
+			&& value != L"off") {
+			wcout << "Invalid normals, expected on or off: " << value << endl;
+			return false;
+		}
+		SetNormals(value == L"on");
+	} else if (option == L"--crease-angle") {
+		SetCreaseAngle(max(0.0, stod(value)));
+	} else if (option == L"--vertex-cache") {
+		SetVertexCache(max(0, stoi(value)));
+	} else if (option == L"--deflection") {
+		if (value != L"global"
+			&& value != L"adaptive") {
+			wcout << "Invalid deflection, expected global or adaptive: " << value << endl;
+			return false;
+		}
+		SetAdaptiveDeflection(value == L"adaptive");
+	} else if (option == L"--triangle-budget") {
+		// A budget is only met by the adaptive deflection
+		SetTriangleBudget(max(0, stoi(value)));
+		if (GetTriangleBudget() > 0)
+			SetAdaptiveDeflection(true);
+	} else if (option == L"--max-triangles") {
+		SetMaxTriangles(max(0, stoi(value)));
+	} else if (option == L"--max-face-triangles") {
+		SetMaxFaceTriangles(max(0, stoi(value)));
+	} else if (option == L"--time-limit") {
+		SetTimeLimit(max(0.0, stod(value)));
+	} else if (option == L"--face-time-limit") {
+		SetFaceTimeLimit(max(0.0, stod(value)));
+	} else if (option == L"--progress") {
+		if (value != L"on"
+			&& value != L"off") {
+			wcout << "Invalid progress, expected on or off: " << value << endl;
+			return false;
+		}
+		SetProgress(value == L"on");
+	} else if (option == L"--transfer-threads") {
+		// 0 takes one session per logical processor
+		int transferThreads = max(0, stoi(value));
+		SetTransferThreads(transferThreads > 0 ? transferThreads : OSD_Parallel::NbLogicalProcessors());
+	} else if (option == L"--scan") {
+		if (value != L"on"
+			&& value != L"off") {
+			wcout << "Invalid scan, expected on or off: " << value << endl;
+			return false;
+		}
+		SetScan(value == L"on");
+	} else if (option == L"--watch") {
+		if (value != L"on"
+			&& value != L"off") {
+			wcout << "Invalid watch, expected on or off: " << value << endl;
+			return false;
+		}
+		SetWatch(value == L"on");
+	} else if (option == L"--watch-jobs") {
+		SetWatchJobs(max(1, stoi(value)));
+	} else if (option == L"--lod") {
+		SetLodLevels(min(max(0, stoi(value)), 4));
+	} else if (option == L"--mass-tolerance") {
+		SetMassTolerance(max(0.0, stod(value)));
+	} else if (option == L"--mesh-cache") {
+		SetMeshCache(value);
+	} else if (option == L"--trace") {
+		SetTrace(value);
+	} else if (option == L"--mem-report") {
+		if (value != L"on"
+			&& value != L"off") {
+			wcout << "Invalid mem-report, expected on or off: " << value << endl;
+			return false;
+		}
+		SetMemReport(value == L"on");
+	} else if (option == L"--shard") {
+		size_t slash = value.find(L"/");
+		int shardIndex = -1;
+		int shardCount = 0;
+
+		// Missing or non-numeric parts are reported as an invalid shard
+		try {
+			if (slash != wstring::npos) {
+				shardIndex = stoi(value.substr(0, slash));
+				shardCount = stoi(value.substr(slash + 1));
+			}
+		} catch (const exception&) {
+			shardCount = 0;
+		}
+
+		if (shardCount < 1
+			|| shardIndex < 0
+			|| shardIndex >= shardCount) {
+			wcout << "Invalid shard, expected k/N with 0 <= k < N: " << value << endl;
+			return false;
+		}
+		SetShard(shardIndex, shardCount);
+	} else {
+		wcout << "No such option: " << option << endl;
+		return false;
+	}
+
+	return true;
 }
\ No newline at end of file
@@ -5,8 +5,33 @@ public:
 	InputOptions();
 	~InputOptions();
 
+	// Set an option from its command line name and value, false with a message if either is invalid
+	bool SetOption(const wstring& option, const wstring& value);
+
 	void SetInput(const wstring& input) { m_input = input; }
 	void SetOutput(const wstring& output) { m_output = output; }
+	void SetFaceReport(int faceReport) { m_faceReport = faceReport; }
+	void SetMeshBounds(bool meshBounds) { m_meshBounds = meshBounds; }
+	void SetNormals(bool normals) { m_normals = normals; }
+	void SetVertexCache(int vertexCache) { m_vertexCache = vertexCache; }
+	void SetLodLevels(int lodLevels) { m_lodLevels = lodLevels; }
+	void SetProgress(bool progress) { m_progress = progress; }
+	void SetScan(bool scan) { m_scan = scan; }
+	void SetWatch(bool watch) { m_watch = watch; }
+	void SetWatchJobs(int watchJobs) { m_watchJobs = watchJobs; }
+	void SetTransferThreads(int transferThreads) { m_transferThreads = transferThreads; }
+	void SetAdaptiveDeflection(bool adaptiveDeflection) { m_adaptiveDeflection = adaptiveDeflection; }
+	void SetTriangleBudget(int triangleBudget) { m_triangleBudget = triangleBudget; }
+	void SetMaxTriangles(int maxTriangles) { m_maxTriangles = maxTriangles; }
+	void SetMaxFaceTriangles(int maxFaceTriangles) { m_maxFaceTriangles = maxFaceTriangles; }
+	void SetTimeLimit(double timeLimit) { m_timeLimit = timeLimit; }
+	void SetFaceTimeLimit(double faceTimeLimit) { m_faceTimeLimit = faceTimeLimit; }
+	void SetCreaseAngle(double creaseAngle) { m_creaseAngle = creaseAngle; }
+	void SetMassTolerance(double massTolerance) { m_massTolerance = massTolerance; }
+	void SetMeshCache(const wstring& meshCache) { m_meshCache = meshCache; }
+	void SetTrace(const wstring& trace) { m_trace = trace; }
+	void SetMemReport(bool memReport) { m_memReport = memReport; }
+	void SetShard(int shardIndex, int shardCount) { m_shardIndex = shardIndex; m_shardCount = shardCount; }
 
 	const wstring& GetInput(void) const { return m_input; }
 	const wstring GetOutput(void) const;
@@ -17,6 +42,31 @@ public:
 	bool GetHtml(void) const { return m_html; }
 	double GetQuality(void) const { return m_quality; }
 	bool GetSFA(void) const { return m_SFA; }
+	int GetFaceReport(void) const { return m_faceReport; }
+	bool GetMeshBounds(void) const { return m_meshBounds; }
+	bool GetNormals(void) const { return m_normals; }
+	int GetVertexCache(void) const { return m_vertexCache; }
+	int GetLodLevels(void) const { return m_lodLevels; }
+	bool GetProgress(void) const { return m_progress; }
+	bool GetScan(void) const { return m_scan; }
+	bool GetWatch(void) const { return m_watch; }
+	int GetWatchJobs(void) const { return m_watchJobs; }
+	int GetTransferThreads(void) const { return m_transferThreads; }
+	bool GetAdaptiveDeflection(void) const { return m_adaptiveDeflection; }
+	int GetTriangleBudget(void) const { return m_triangleBudget; }
+	int GetMaxTriangles(void) const { return m_maxTriangles; }
+	int GetMaxFaceTriangles(void) const { return m_maxFaceTriangles; }
+	double GetTimeLimit(void) const { return m_timeLimit; }
+	double GetFaceTimeLimit(void) const { return m_faceTimeLimit; }
+	bool HasTessellationLimit(void) const { return m_maxTriangles > 0 || m_maxFaceTriangles > 0 || m_timeLimit > 0.0 || m_faceTimeLimit > 0.0; }
+	double GetCreaseAngle(void) const { return m_creaseAngle; }
+	double GetMassTolerance(void) const { return m_massTolerance; }
+	const wstring& GetMeshCache(void) const { return m_meshCache; }
+	const wstring& GetTrace(void) const { return m_trace; }
+	bool GetMemReport(void) const { return m_memReport; }
+	int GetShardIndex(void) const { return m_shardIndex; }
+	int GetShardCount(void) const { return m_shardCount; }
+	bool IsSharded(void) const { return m_shardCount > 1; }
 
 	// Software version (as of Feb 2022)
 	const wstring Version(void) const { return L"1.21"; }
@@ -29,4 +79,27 @@ private:
 	bool m_html;		// Output file type, html or x3d
 	double m_quality;	// Mesh quality
 	bool m_SFA;			// Specific to SFA
+	int m_faceReport;	// Number of worst faces to report, 0 = no per-face instrumentation
+	bool m_meshBounds;	// Bounding boxes of the mesh nodes instead of the B-rep
+	bool m_normals;		// Vertex normals in the output
+	double m_creaseAngle;	// Radians between triangles smoothed together when normals are averaged
+	int m_vertexCache;	// Vertex cache size the triangle order is optimized for, 0 = BRepMesh order
+	bool m_progress;	// Print the translation progress
+	int m_transferThreads;	// Work sessions transferring the STEP roots in parallel, 1 = one after the other
+	bool m_scan;		// Only scan the STEP text for its header, entity counts and cost, no translation
+	bool m_watch;		// Convert the STEP files written to the input directory until stopped
+	int m_watchJobs;	// Conversions running at the same time in watch mode
+	int m_lodLevels;	// Simplified levels of detail per IShape, each with half the triangles of the previous, 0 = none
+	bool m_adaptiveDeflection;	// Deflection relative to each solid and face instead of the root box
+	int m_triangleBudget;	// Triangles the adaptive deflection aims at for the model, 0 = no budget
+	int m_maxTriangles;		// Triangles of the model above which the heaviest faces are coarsened, 0 = no limit
+	int m_maxFaceTriangles;	// Triangles of a face above which it is coarsened, 0 = no limit
+	double m_timeLimit;		// Seconds of meshing for the model before the remaining faces are meshed coarse, 0 = no limit
+	double m_faceTimeLimit;	// Seconds of meshing for a face meshed on its own, 0 = no limit
+	double m_massTolerance;	// Relative error of the adaptive mass property integration, 0 = fixed Gauss points
+	wstring m_meshCache;	// Directory of meshes cached per solid fingerprint, empty = no cache
+	wstring m_trace;		// Chrome trace of the pipeline stages, empty = not recorded
+	bool m_memReport;		// Working set per stage and bytes of the meshes in the output
+	int m_shardIndex;	// Shard processed by this run, in [0, m_shardCount)
+	int m_shardCount;	// Number of shards the root shape is split into, 1 = no sharding
 };
\ No newline at end of file
@@ -3,12 +3,15 @@
 #include "Component.h"
 #include "IShape.h"
 #include "Mesh.h"
+#include "MemoryReport.h"
 
 #include <nlohmann/json.hpp>
 using json = nlohmann::json;
 
 JsonWriter::JsonWriter(InputOptions* opt)
-	: m_opt(opt) {
+	: m_opt(opt),
+	m_memoryReport(nullptr),
+	m_appearanceList(json::array()) {
 	// Attributes for Appearance nodes
 	m_diffuseColor.SetValues(0.55, 0.55, 0.6, Quantity_TOC_RGB);
 	m_emissiveColor.SetValues(1.0, 1.0, 1.0, Quantity_TOC_RGB);
@@ -28,17 +31,17 @@ JsonWriter::~JsonWriter(void) {
 	Clear();
 }
 
-void JsonWriter::WriteJson(Model*& model) {
-	// Initial indent level
-	int level = 0;
-	json jsonContainer = json::object();
-	json modelJson = json::object();
-	modelJson["boundingBox"] = GetBoundingBox(model);
-	modelJson["components"] = GetComponents(model);
-	jsonContainer["model"] = modelJson;
+bool JsonWriter::WriteJson(Model*& model, const Message_ProgressRange& range) {
+	Message_ProgressScope scope(range, "Writing JSON", 3);
+
+	TraceScope trace("WriteJson", "write");
+
+	string jsonString;
+	if (!SerializeJson(model, jsonString, scope.Next(2)))
+		return false;
 
-	std::string jsonString = jsonContainer.dump();
 	// Write JSON file
+	TraceScope fileTrace("WriteFile", "write");
 	wstring filePath = m_opt->GetOutputJson();
 	wofstream wof;
 	// This line is required to write Unicode characters.
@@ -47,12 +50,70 @@ void JsonWriter::WriteJson(Model*& model) {
 	wof.open(filePath.c_str());
 	wof << jsonString.c_str();
 	wof.close();
+
+	scope.Next();
+
+	return true;
+}
+
+bool JsonWriter::SerializeJson(Model*& model, string& jsonString, const Message_ProgressRange& range) {
+	Message_ProgressScope scope(range, "Serializing", 2);
+
+	// Initial indent level
+	int level = 0;
+	json jsonContainer = json::object();
+	json modelJson = json::object();
+	{
+		TraceScope boundsTrace("BoundingBox", "write");
+		modelJson["boundingBox"] = GetBoundingBox(model);
+	}
+	{
+		TraceScope componentsTrace("Components", "write");
+		modelJson["components"] = GetComponents(model);
+	}
+	modelJson["appearances"] = m_appearanceList;
+	modelJson["degradedFaceCount"] = CountDegradedFaces(model);
+
+	scope.Next();
+	if (!scope.More())
+		return false;
+
+	// Sharded runs are combined afterwards by stpcalc_merge
+	const ShardInfo& shardInfo = model->GetShardInfo();
+	if (shardInfo.count > 1) {
+		json shard = json::object();
+		shard["index"] = shardInfo.index;
+		shard["count"] = shardInfo.count;
+		shard["solidBegin"] = shardInfo.solidBegin;
+		shard["solidEnd"] = shardInfo.solidEnd;
+		shard["solidSize"] = shardInfo.solidSize;
+		modelJson["shard"] = shard;
+	}
+	jsonContainer["model"] = modelJson;
+
+	// Sampled with the document built, before it is dumped
+	if (m_memoryReport) {
+		m_memoryReport->EndStage("serialize");
+		jsonContainer["memoryReport"] = m_memoryReport->GetJson();
+	}
+
+	{
+		TraceScope dumpTrace("Dump", "write");
+		jsonString = jsonContainer.dump();
+	}
+
+	scope.Next();
+
+	return true;
 }
 
 json JsonWriter::GetBoundingBox(Model*& model) const {
 	Bnd_Box bndBox = model->GetBoundingBox(m_opt->GetSketch());
 	bndBox.SetGap(0.0);
-	assert(!bndBox.IsVoid());
+
+	// A shard may hold no geometry at all
+	if (bndBox.IsVoid())
+		return json::object();
 
 	double X_min = 0.0, Y_min = 0.0, Z_min = 0.0;
 	double X_max = 0.0, Y_max = 0.0, Z_max = 0.0;
@@ -69,21 +130,89 @@ json JsonWriter::GetBoundingBox(Model*& model) const {
 	return boundingBox;
 }
 
+json JsonWriter::GetOrientedBoundingBox(const Bnd_OBB& obb) const {
+	if (obb.IsVoid())
+		return json::object();
+
+	auto toJson = [](const gp_XYZ& xyz) {
+		json vec = json::object();
+		vec["x"] = xyz.X();
+		vec["y"] = xyz.Y();
+		vec["z"] = xyz.Z();
+		return vec;
+	};
+
+	json orientedBoundingBox = json::object();
+	orientedBoundingBox["center"] = toJson(obb.Center());
+	orientedBoundingBox["xAxis"] = toJson(obb.XDirection());
+	orientedBoundingBox["yAxis"] = toJson(obb.YDirection());
+	orientedBoundingBox["zAxis"] = toJson(obb.ZDirection());
+	orientedBoundingBox["halfSize"] = toJson(gp_XYZ(obb.XHSize(), obb.YHSize(), obb.ZHSize()));
+
+	// Stock dimensions, longest first
+	vector<double> stockSize = { 2.0 * obb.XHSize(), 2.0 * obb.YHSize(), 2.0 * obb.ZHSize() };
+	sort(stockSize.begin(), stockSize.end(), greater<double>());
+	orientedBoundingBox["stockSize"] = stockSize;
+
+	return orientedBoundingBox;
+}
+
+json JsonWriter::GetMassProperties(const MassProperties& massProperties) const {
+	const gp_XYZ& centerOfMass = massProperties.GetCenterOfMass();
+	const gp_Mat& inertia = massProperties.GetInertia();
+
+	json properties = json::object();
+	properties["volume"] = massProperties.GetVolume();
+	properties["area"] = massProperties.GetArea();
+	properties["centerOfMass"] = { { "x", centerOfMass.X() }, { "y", centerOfMass.Y() }, { "z", centerOfMass.Z() } };
+
+	// Row-major, about the center of mass for unit density
+	vector<double> inertiaValues;
+	for (int i = 1; i <= 3; ++i) {
+		for (int j = 1; j <= 3; ++j)
+			inertiaValues.push_back(inertia.Value(i, j));
+	}
+	properties["inertia"] = inertiaValues;
+
+	return properties;
+}
+
+int JsonWriter::CountDegradedFaces(Model*& model) const {
+	vector<Component*> comps;
+	model->GetAllComponents(comps);
+
+	int degradedFaceCount = 0;
+	for (const auto& comp : comps) {
+		for (int i = 0; i < comp->GetIShapeSize(); ++i) {
+			IShape* iShape = comp->GetIShapeAt(i);
+
+			for (int j = 0; j < iShape->GetMeshSize(); ++j) {
+				if (iShape->GetMeshAt(j)->IsDegraded())
+					degradedFaceCount++;
+			}
+		}
+	}
+
+	comps.clear();
+
+	return degradedFaceCount;
+}
+
 json JsonWriter::GetComponents(Model*& model) {
 	json componentList = json::array();
-	if (model->GetComponentSize() < 2) {
-		for (int i = 0; i < model->GetComponentSize(); i++) {
-			Component* rootComp = model->GetComponentAt(i);
-			if (m_opt->GetSFA() // SFA-specific
-				&& rootComp->GetIShapeSize() == 1
-				&& rootComp->GetIShapeAt(0)->IsSketchGeometry()) {
-				//TO MANAGE
-				//CHECK IF SOME CASES HAVE SKETCH GEOMETRY
-				//IShape* shape = rootComp->GetIShapeAt(0);
-				//ss_model << WriteSketchGeometry(shape, level + 1);
-			} else {
-				componentList.push_back(WriteComponent(rootComp));
-			}
+
+	// One root component per STEP root
+	for (int i = 0; i < model->GetComponentSize(); i++) {
+		Component* rootComp = model->GetComponentAt(i);
+		if (m_opt->GetSFA() // SFA-specific
+			&& rootComp->GetIShapeSize() == 1
+			&& rootComp->GetIShapeAt(0)->IsSketchGeometry()) {
+			//TO MANAGE
+			//CHECK IF SOME CASES HAVE SKETCH GEOMETRY
+			//IShape* shape = rootComp->GetIShapeAt(0);
+			//ss_model << WriteSketchGeometry(shape, level + 1);
+		} else {
+			componentList.push_back(WriteComponent(rootComp));
 		}
 	}
 	return componentList;
@@ -177,6 +306,7 @@ json JsonWriter::WriteComponent(Component*& comp) {
 
 	shape["shapes"] = shapeList;
 	shape["componentName"] = comp->GetName().c_str();
+	shape["orientedBoundingBox"] = GetOrientedBoundingBox(comp->GetOrientedBoundingBox());
 	return shape;
 }
 
@@ -208,6 +338,7 @@ wstring JsonWriter::WriteTransformAttributes(const gp_Trsf& trsf) const {
 }
 
 json JsonWriter::WriteShape(IShape*& iShape) {
+	TraceScope trace("WriteShape", "write", "shape", iShape->GetGlobalIndex());
 	json shape = json::object();
 
 	if (iShape->IsFaceSet()) {
@@ -215,11 +346,36 @@ json JsonWriter::WriteShape(IShape*& iShape) {
 		shape["shapeID"] = shapeId.c_str();
 		shape["shapeName"] = iShape->GetName().c_str();
 		shape["stepID"] = iShape->GetStepID();
+		shape["globalIndex"] = iShape->GetGlobalIndex();
 		shape["volume"] = iShape->GetVolume();
+
+		json massProperties = GetMassProperties(iShape->GetMassProperties());
+		shape["area"] = massProperties["area"];
+		shape["centerOfMass"] = massProperties["centerOfMass"];
+		shape["inertia"] = massProperties["inertia"];
+
+		// Per-solid breakdown in explorer order
+		json solids = json::array();
+		for (int i = 0; i < iShape->GetSolidPropertiesSize(); ++i) {
+			json solid = GetMassProperties(iShape->GetSolidPropertiesAt(i));
+
+			// Stock size per part
+			if (i < iShape->GetSolidObbSize())
+				solid["orientedBoundingBox"] = GetOrientedBoundingBox(iShape->GetSolidObbAt(i));
+
+			solids.push_back(solid);
+		}
+		shape["solids"] = solids;
+
+		shape["orientedBoundingBox"] = GetOrientedBoundingBox(iShape->GetOrientedBoundingBox());
 		vector<json> propertyList = WriteIndexedFaceSet(iShape);
-		shape["appearance"] = propertyList[0];
+		shape["appearanceID"] = propertyList[0];
 		shape["faceSet"] = propertyList[1];
 		shape["mesh"] = propertyList[2];
+
+		// Simplified meshes, coarsest last
+		if (iShape->GetLodSize() > 0)
+			shape["lods"] = WriteLods(iShape);
 		/*
 		if (m_opt->Edge()) // Boundary edges
 		{
@@ -346,12 +502,24 @@ wstring JsonWriter::WriteIndexedLineSet(IShape*& iShape, int level) {
 	return ss_ils.str();
 }
 
-json JsonWriter::WriteAppearance(IShape*& iShape, const Quantity_Color& diffuseColor, bool isDiffuseOn,
-								 const Quantity_Color& emissiveColor, bool isEmissiveOn,
-								 const Quantity_Color& specularColor, bool isSpecularOn,
-								 double& shininess, bool isShininessOn,
-								 double& ambientIntensity, bool isAmbientIntensityOn,
-								 double& transparency, bool isTransparencyOn) {
+int JsonWriter::WriteAppearance(IShape*& iShape, const Quantity_Color& diffuseColor, bool isDiffuseOn,
+								const Quantity_Color& emissiveColor, bool isEmissiveOn,
+								const Quantity_Color& specularColor, bool isSpecularOn,
+								double& shininess, bool isShininessOn,
+								double& ambientIntensity, bool isAmbientIntensityOn,
+								double& transparency, bool isTransparencyOn) {
+	int appID = 0;
+
+	// Shared appearances are written once in the model and referenced by ID
+	if (CheckSameAppearance(diffuseColor, isDiffuseOn,
+							emissiveColor, isEmissiveOn,
+							specularColor, isSpecularOn,
+							shininess, isShininessOn,
+							ambientIntensity, isAmbientIntensityOn,
+							transparency, isTransparencyOn,
+							appID))
+		return appID;
+
 	json appearanceProperty = json::object();
 	wstringstream ss_app;
 	if (isDiffuseOn) {
@@ -384,14 +552,39 @@ json JsonWriter::WriteAppearance(IShape*& iShape, const Quantity_Color& diffuseC
 	if (isTransparencyOn) {
 		appearanceProperty["transparency"] = transparency;
 	}
-	return appearanceProperty;
+	m_appearanceList.push_back(appearanceProperty);
+
+	return appID;
 }
 
 json JsonWriter::WriteMesh(IShape*& iShape) const {
+	vector<Mesh*> meshes;
+	for (int i = 0; i < iShape->GetMeshSize(); ++i)
+		meshes.push_back(iShape->GetMeshAt(i));
+
+	return WriteMeshList(meshes);
+}
+
+json JsonWriter::WriteLods(IShape*& iShape) const {
+	json lodListJson = json::array();
+	for (int level = 0; level < iShape->GetLodSize(); ++level) {
+		vector<Mesh*> meshes;
+		for (int i = 0; i < iShape->GetMeshSize(); ++i)
+			meshes.push_back(iShape->GetLodMeshAt(level, i));
+
+		json lodJson = json::object();
+		lodJson["level"] = level + 1;
+		lodJson["mesh"] = WriteMeshList(meshes);
+		lodListJson.push_back(lodJson);
+	}
+	return lodListJson;
+}
+
+json JsonWriter::WriteMeshList(const vector<Mesh*>& meshes) const {
 	json meshListJson = json::array();
 	int prevCoordCount = 0; // The number of previous coordinates
-	for (int i = 0; i < iShape->GetMeshSize(); ++i) {
-		Mesh* mesh = iShape->GetMeshAt(i);
+	int prevNormalCount = 0; // The number of previous normals
+	for (const auto& mesh : meshes) {
 		json meshJson = json::object();
 		json meshCoordinates = json::array();
 		for (int j = 0; j < mesh->GetCoordinateSize(); ++j) {
@@ -407,7 +600,7 @@ json JsonWriter::WriteMesh(IShape*& iShape) const {
 		// Traverse triangles
 		wstringstream ss_coordIndex;
 		for (int j = 0; j < mesh->GetFaceIndexSize(); ++j) {
-			const vector<int>& faceIndex = mesh->GetFaceIndexAt(j);
+			const Index& faceIndex = mesh->GetFaceIndexAt(j);
 			ss_coordIndex << to_wstring(faceIndex[0] - 1 + prevCoordCount) << " ";
 			ss_coordIndex << to_wstring(faceIndex[1] - 1 + prevCoordCount) << " ";
 			ss_coordIndex << to_wstring(faceIndex[2] - 1 + prevCoordCount) << " ";
@@ -419,7 +612,7 @@ json JsonWriter::WriteMesh(IShape*& iShape) const {
 		// Traverse edges
 		wstringstream ss_edgeIndex;
 		for (int j = 0; j < mesh->GetEdgeIndexSize(); ++j) {
-			const vector<int>& edgeIndex = mesh->GetEdgeIndexAt(j);
+			const Index& edgeIndex = mesh->GetEdgeIndexAt(j);
 
 			for (size_t k = 0; k < edgeIndex.size(); ++k) {
 				int index = edgeIndex[k] - 1 + prevCoordCount;
@@ -432,7 +625,37 @@ json JsonWriter::WriteMesh(IShape*& iShape) const {
 		meshJson["edgeIndex"] = edgeIndex.c_str();
 		meshJson["edgePerimeter"] = mesh->GetEdgePerimeter();
 
+		// Face meshed coarser than requested to stay within a tessellation budget
+		if (mesh->IsDegraded())
+			meshJson["degraded"] = true;
+
+		// Vertex normals, only with the normals option
+		if (mesh->GetNormalSize() > 0) {
+			json meshNormals = json::array();
+			for (int j = 0; j < mesh->GetNormalSize(); ++j) {
+				const gp_XYZ& norm = mesh->GetNormalAt(j);
+				json normal = json::object();
+				normal["x"] = norm.X();
+				normal["y"] = norm.Y();
+				normal["z"] = norm.Z();
+				meshNormals.push_back(normal);
+			}
+			meshJson["normals"] = meshNormals;
+
+			wstringstream ss_normalIndex;
+			for (int j = 0; j < mesh->GetNormalIndexSize(); ++j) {
+				const Index& normalIndex = mesh->GetNormalIndexAt(j);
+				ss_normalIndex << to_wstring(normalIndex[0] - 1 + prevNormalCount) << " ";
+				ss_normalIndex << to_wstring(normalIndex[1] - 1 + prevNormalCount) << " ";
+				ss_normalIndex << to_wstring(normalIndex[2] - 1 + prevNormalCount) << " ";
+				ss_normalIndex << "-1 ";
+			}
+			wstring normalIndex = ss_normalIndex.str();
+			meshJson["normalIndex"] = normalIndex.c_str();
+		}
+
 		prevCoordCount += mesh->GetCoordinateSize();
+		prevNormalCount += mesh->GetNormalSize();
 		meshListJson.push_back(meshJson);
 	}
 	return meshListJson;
@@ -451,7 +674,7 @@ wstring JsonWriter::WriteCoordinateIndex(IShape*& iShape, bool faceMesh) const {
 		{
 			// Traverse triangles
 			for (int j = 0; j < mesh->GetFaceIndexSize(); ++j) {
-				const vector<int>& faceIndex = mesh->GetFaceIndexAt(j);
+				const Index& faceIndex = mesh->GetFaceIndexAt(j);
 
 				ss_coordIndex << to_wstring(faceIndex[0] - 1 + prevCoordCount) << " ";
 				ss_coordIndex << to_wstring(faceIndex[1] - 1 + prevCoordCount) << " ";
@@ -462,7 +685,7 @@ wstring JsonWriter::WriteCoordinateIndex(IShape*& iShape, bool faceMesh) const {
 		{
 			// Traverse edges
 			for (int j = 0; j < mesh->GetEdgeIndexSize(); ++j) {
-				const vector<int>& edgeIndex = mesh->GetEdgeIndexAt(j);
+				const Index& edgeIndex = mesh->GetEdgeIndexAt(j);
 
 				for (size_t k = 0; k < edgeIndex.size(); ++k) {
 					int index = edgeIndex[k] - 1 + prevCoordCount;
@@ -486,22 +709,22 @@ wstring JsonWriter::WriteNormalIndex(IShape*& iShape) const {
 	wstringstream ss_normalIndex;
 	ss_normalIndex << " normalIndex='";
 
-	int prevCoordCount = 0; // The number of previous coordinates
+	int prevNormalCount = 0; // The number of previous normals
 
 	for (int i = 0; i < iShape->GetMeshSize(); ++i) {
 		Mesh* mesh = iShape->GetMeshAt(i);
 
 		// Traverse triangles
 		for (int j = 0; j < mesh->GetNormalIndexSize(); ++j) {
-			const vector<int>& normalIndex = mesh->GetNormalIndexAt(j);
+			const Index& normalIndex = mesh->GetNormalIndexAt(j);
 
-			ss_normalIndex << to_wstring(normalIndex[0] - 1 + prevCoordCount) << " ";
-			ss_normalIndex << to_wstring(normalIndex[1] - 1 + prevCoordCount) << " ";
-			ss_normalIndex << to_wstring(normalIndex[2] - 1 + prevCoordCount) << " ";
+			ss_normalIndex << to_wstring(normalIndex[0] - 1 + prevNormalCount) << " ";
+			ss_normalIndex << to_wstring(normalIndex[1] - 1 + prevNormalCount) << " ";
+			ss_normalIndex << to_wstring(normalIndex[2] - 1 + prevNormalCount) << " ";
 			ss_normalIndex << "-1 ";
 		}
 
-		prevCoordCount += mesh->GetCoordinateSize();
+		prevNormalCount += mesh->GetNormalSize();
 	}
 
 	ss_normalIndex << "'";
@@ -578,35 +801,8 @@ bool JsonWriter::CheckSameAppearance(const Quantity_Color& diffuseColor, bool is
 									 double& ambientIntensity, bool isAmbientIntensityOn,
 									 double& transparency, bool isTransparencyOn,
 									 int& appID) {
-	// Search for the same appearance
-	for (int i = 0; i < (int)m_appearances.size(); ++i) {
-		AppearanceJson app = m_appearances[i];
-
-		if (app.isDiffuseOn == isDiffuseOn
-			&& ((isDiffuseOn && app.diffuseColor.IsEqual(diffuseColor))
-				|| !isDiffuseOn) &&
-			app.isEmissiveOn == isEmissiveOn
-			&& ((isEmissiveOn && app.emissiveColor.IsEqual(emissiveColor))
-				|| !isEmissiveOn) &&
-			app.isSpecularOn == isSpecularOn
-			&& ((isSpecularOn && app.specularColor.IsEqual(specularColor))
-				|| !isSpecularOn) &&
-			app.isShininessOn == isShininessOn
-			&& ((isShininessOn && abs(app.shininess - shininess) <= Precision::Confusion())
-				|| !isShininessOn) &&
-			app.isAmbientIntensityOn == isAmbientIntensityOn
-			&& ((isAmbientIntensityOn && abs(app.ambientIntensity - ambientIntensity) <= Precision::Confusion())
-				|| !isAmbientIntensityOn) &&
-			app.isTransparencyOn == isTransparencyOn
-			&& ((isTransparencyOn && abs(app.transparency - transparency) <= Precision::Confusion())
-				|| !isTransparencyOn)) {
-			appID = i; // Save the order
-			return true;
-		}
-	}
-
-	// Save the current appearance
-	AppearanceJson app;
+	// Look up the quantized appearance
+	Appearance app;
 	app.diffuseColor = diffuseColor;
 	app.emissiveColor = emissiveColor;
 	app.specularColor = specularColor;
@@ -619,12 +815,8 @@ bool JsonWriter::CheckSameAppearance(const Quantity_Color& diffuseColor, bool is
 	app.isShininessOn = isShininessOn;
 	app.isAmbientIntensityOn = isAmbientIntensityOn;
 	app.isTransparencyOn = isTransparencyOn;
-	m_appearances.push_back(app);
-
-	// Save the latest order
-	appID = (int)m_appearances.size() - 1;
 
-	return false;
+	return m_appRegistry.Register(app, appID);
 }
 
 void JsonWriter::CountIndent(int level) {
@@ -646,10 +838,11 @@ void JsonWriter::PrintIndentCount(void) {
 }
 
 void JsonWriter::PrintMaterialCount(void) const {
-	printf("Number of Materials: %d\n", (int)m_appearances.size());
+	printf("Number of Materials: %d\n", m_appRegistry.GetAppearanceSize());
 }
 
 void JsonWriter::Clear(void) {
-	m_appearances.clear();
+	m_appRegistry.Clear();
+	m_appearanceList.clear();
 	m_indentCountMap.clear();
 }
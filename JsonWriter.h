@@ -1,36 +1,38 @@
 #pragma once
 
 #include <nlohmann/json.hpp>
+#include "AppearanceRegistry.h"
 using json = nlohmann::json;
 
 class Component;
 class IShape;
-
-struct AppearanceJson {
-	Quantity_Color diffuseColor;
-	Quantity_Color specularColor;
-	Quantity_Color emissiveColor;
-	double shininess = 0.0;
-	double ambientIntensity = 0.0;
-	double transparency = 0.0;
-
-	bool isDiffuseOn = false;
-	bool isEmissiveOn = false;
-	bool isSpecularOn = false;
-	bool isShininessOn = false;
-	bool isAmbientIntensityOn = false;
-	bool isTransparencyOn = false;
-};
+class MassProperties;
+class MemoryReport;
+class Mesh;
+class WriterBenchmark;
 
 class JsonWriter {
+	friend class WriterBenchmark;	// Times the serialization paths directly
+
 public:
 	JsonWriter(InputOptions* opt);
 	~JsonWriter(void);
 
-	void WriteJson(Model*& model);
+	// False when cancelled through the progress range, nothing is written then
+	bool WriteJson(Model*& model, const Message_ProgressRange& range = Message_ProgressRange());
+
+	// The document WriteJson writes, kept in memory
+	bool SerializeJson(Model*& model, string& jsonString, const Message_ProgressRange& range = Message_ProgressRange());
+
+	// Stages up to the serialization are added to the document, nullptr writes none
+	void SetMemoryReport(MemoryReport* memoryReport) { m_memoryReport = memoryReport; }
 
 protected:
 	json GetBoundingBox(Model*& model) const;
+	json GetOrientedBoundingBox(const Bnd_OBB& obb) const;
+	json GetMassProperties(const MassProperties& massProperties) const;
+
+	int CountDegradedFaces(Model*& model) const;
 
 	json GetComponents(Model*& model);
 	json WriteComponent(Component*& comp);
@@ -40,13 +42,15 @@ protected:
 	vector<json> WriteIndexedFaceSet(IShape*& iShape);
 	wstring WriteIndexedLineSet(IShape*& iShape, int level);
 
-	json WriteAppearance(IShape*& iShape, const Quantity_Color& diffuseColor, bool isDiffuseOn,
+	int WriteAppearance(IShape*& iShape, const Quantity_Color& diffuseColor, bool isDiffuseOn,
 							const Quantity_Color& emissiveColor, bool isEmissiveOn,
 							const Quantity_Color& specularColor, bool isSpecularOn,
 							double& shininess, bool isShininessOn,
 							double& ambientIntensity, bool isAmbientIntensityOn,
 							double& transparency, bool isTransparencyOn);
 	json WriteMesh(IShape*& iShape) const;
+	json WriteLods(IShape*& iShape) const;
+	json WriteMeshList(const vector<Mesh*>& meshes) const;
 	wstring WriteCoordinateIndex(IShape*& iShape, bool faceMesh) const;
 	wstring WriteNormalIndex(IShape*& iShape) const;
 	wstring WriteColor(IShape*& iShape) const;
@@ -73,6 +77,7 @@ protected:
 
 private:
 	InputOptions* m_opt;
+	MemoryReport* m_memoryReport;
 
 	Quantity_Color m_diffuseColor;
 	Quantity_Color m_emissiveColor;
@@ -85,7 +90,8 @@ private:
 
 	double m_creaseAngle;
 
-	vector<AppearanceJson> m_appearances;
+	AppearanceRegistry m_appRegistry;
+	json m_appearanceList;	// Properties of each registered appearance, indexed by ID
 
 	// SFA-specific variables
 	map<int, int> m_indentCountMap;
@@ -0,0 +1,84 @@
+#include "CommonImport.h"
+#include "MassProperties.h"
+
+MassProperties::MassProperties(void)
+	: m_volume(0.0),
+	m_area(0.0),
+	m_centerOfMass(0.0, 0.0, 0.0),
+	m_inertia(0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0) {}
+
+MassProperties::~MassProperties(void) {}
+
+void MassProperties::Compute(const TopoDS_Shape& shape, double tolerance) {
+	GProp_GProps volumeProps;
+	GProp_GProps surfaceProps;
+
+	if (tolerance > 0.0) {
+		BRepGProp::VolumeProperties(shape, volumeProps, tolerance);
+		BRepGProp::SurfaceProperties(shape, surfaceProps, tolerance);
+	} else {
+		BRepGProp::VolumeProperties(shape, volumeProps);
+		BRepGProp::SurfaceProperties(shape, surfaceProps);
+	}
+
+	m_volume = volumeProps.Mass();
+	m_area = surfaceProps.Mass();
+
+	// Shapes without volume, such as open shells, have no center of mass
+	if (abs(m_volume) > Precision::Confusion()) {
+		m_centerOfMass = volumeProps.CentreOfMass().XYZ();
+		m_inertia = volumeProps.MatrixOfInertia();
+	} else {
+		m_centerOfMass.SetCoord(0.0, 0.0, 0.0);
+		m_inertia = gp_Mat(0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0, 0.0);
+	}
+}
+
+void MassProperties::Add(const MassProperties& other) {
+	double volume = m_volume + other.m_volume;
+	m_area += other.m_area;
+
+	if (abs(volume) <= Precision::Confusion()) {
+		m_volume = volume;
+		return;
+	}
+
+	gp_XYZ centerOfMass = (m_centerOfMass * m_volume + other.m_centerOfMass * other.m_volume) / volume;
+
+	gp_Mat inertia = ShiftInertia(m_inertia, m_volume, m_centerOfMass - centerOfMass);
+	gp_Mat otherInertia = ShiftInertia(other.m_inertia, other.m_volume, other.m_centerOfMass - centerOfMass);
+
+	for (int i = 1; i <= 3; ++i) {
+		for (int j = 1; j <= 3; ++j)
+			inertia.SetValue(i, j, inertia.Value(i, j) + otherInertia.Value(i, j));
+	}
+
+	m_volume = volume;
+	m_centerOfMass = centerOfMass;
+	m_inertia = inertia;
+}
+
+void MassProperties::Set(double volume, double area, const gp_XYZ& centerOfMass, const gp_Mat& inertia) {
+	m_volume = volume;
+	m_area = area;
+	m_centerOfMass = centerOfMass;
+	m_inertia = inertia;
+}
+
+gp_Mat MassProperties::ShiftInertia(const gp_Mat& inertia, double volume, const gp_XYZ& offset) {
+	// Parallel axis theorem, I + m * (|d|^2 E - d d^T)
+	gp_Mat shifted = inertia;
+	double squareOffset = offset.SquareModulus();
+
+	for (int i = 1; i <= 3; ++i) {
+		for (int j = 1; j <= 3; ++j) {
+			double value = -offset.Coord(i) * offset.Coord(j);
+			if (i == j)
+				value += squareOffset;
+
+			shifted.SetValue(i, j, shifted.Value(i, j) + volume * value);
+		}
+	}
+
+	return shifted;
+}
\ No newline at end of file
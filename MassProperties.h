@@ -0,0 +1,30 @@
+#pragma once
+
+// Volume, surface area, center of mass and inertia tensor of a solid, or of several solids added together
+class MassProperties {
+public:
+	MassProperties(void);
+	~MassProperties(void);
+
+	// Integrate the B-rep, a positive tolerance bounds the relative error of the adaptive integration
+	void Compute(const TopoDS_Shape& shape, double tolerance = 0.0);
+
+	// Combine with other, moving both inertia tensors to the common center of mass
+	void Add(const MassProperties& other);
+
+	void Set(double volume, double area, const gp_XYZ& centerOfMass, const gp_Mat& inertia);
+
+	const double GetVolume(void) const { return m_volume; }
+	const double GetArea(void) const { return m_area; }
+	const gp_XYZ& GetCenterOfMass(void) const { return m_centerOfMass; }
+	const gp_Mat& GetInertia(void) const { return m_inertia; }	// About the center of mass, unit density
+
+protected:
+	static gp_Mat ShiftInertia(const gp_Mat& inertia, double volume, const gp_XYZ& offset);
+
+private:
+	double m_volume;
+	double m_area;
+	gp_XYZ m_centerOfMass;
+	gp_Mat m_inertia;
+};
\ No newline at end of file
@@ -0,0 +1,187 @@
+#include "CommonImport.h"
+#include "MemoryReport.h"
+#include "Component.h"
+#include "IShape.h"
+#include "Mesh.h"
+#include <fstream>
+#include <iomanip>
+
+namespace fs = std::filesystem;
+
+MemoryReport::MemoryReport(void)
+	: m_inputBytes(0),
+	m_isPeakPerStage(false),
+	m_meshCount(0),
+	m_wideMeshCount(0),
+	m_coordinateBytes(0),
+	m_normalBytes(0),
+	m_indexBytes(0),
+	m_edgeBytes(0),
+	m_triangulationBytes(0),
+	m_arenaBytes(0) {}
+
+MemoryReport::~MemoryReport(void) {}
+
+void MemoryReport::Start(const filesystem::path& inputPath) {
+	error_code ec;
+	m_inputBytes = fs::is_regular_file(inputPath, ec) ? (size_t)fs::file_size(inputPath, ec) : 0;
+
+	m_stages.clear();
+	m_isPeakPerStage = ResetPeak();
+	m_stageStart = chrono::steady_clock::now();
+}
+
+void MemoryReport::EndStage(const string& name) {
+	MemoryStage stage;
+	stage.name = name;
+	stage.seconds = chrono::duration<double>(chrono::steady_clock::now() - m_stageStart).count();
+	stage.workingSet = GetMemory(OSD_MemInfo::MemWorkingSet);
+	stage.peakWorkingSet = GetMemory(OSD_MemInfo::MemWorkingSetPeak);
+	stage.heapUsage = GetMemory(OSD_MemInfo::MemHeapUsage);
+	m_stages.push_back(stage);
+
+	m_isPeakPerStage &= ResetPeak();
+	m_stageStart = chrono::steady_clock::now();
+}
+
+void MemoryReport::AddModel(Model* model) {
+	vector<Component*> comps;
+	model->GetAllComponents(comps);
+
+	TopTools_IndexedMapOfShape faceMap;	// Faces shared by several shapes hold one triangulation
+	for (const auto& comp : comps) {
+		for (int i = 0; i < comp->GetIShapeSize(); ++i) {
+			IShape* iShape = comp->GetIShapeAt(i);
+			AddTriangulations(iShape->GetShape(), faceMap);
+
+			for (int j = 0; j < iShape->GetMeshSize(); ++j) {
+				Mesh* mesh = iShape->GetMeshAt(j);
+				m_coordinateBytes += mesh->GetCoordinateBytes();
+				m_normalBytes += mesh->GetNormalBytes();
+				m_indexBytes += mesh->GetIndexBytes();
+				m_edgeBytes += mesh->GetEdgeBytes();
+				m_meshCount++;
+
+				if (mesh->GetFaceIndexes().IsWide())
+					m_wideMeshCount++;
+			}
+		}
+	}
+
+	m_arenaBytes = model->GetArena().GetAllocatedSize();
+}
+
+void MemoryReport::AddTriangulations(const TopoDS_Shape& shape, TopTools_IndexedMapOfShape& faceMap) {
+	TopExp_Explorer ExpFace;
+	for (ExpFace.Init(shape, TopAbs_FACE); ExpFace.More(); ExpFace.Next()) {
+		const TopoDS_Face& face = TopoDS::Face(ExpFace.Current());
+
+		int faceCount = faceMap.Extent();
+		if (faceMap.Add(face) <= faceCount)
+			continue;
+
+		TopLoc_Location loc;
+		const Handle(Poly_Triangulation)& myT = BRep_Tool::Triangulation(face, loc);
+		if (myT.IsNull())
+			continue;
+
+		size_t bytes = sizeof(Poly_Triangulation);
+		bytes += (size_t)myT->NbNodes() * sizeof(gp_Pnt);
+		bytes += (size_t)myT->NbTriangles() * sizeof(Poly_Triangle);
+		if (myT->HasUVNodes())
+			bytes += (size_t)myT->NbNodes() * sizeof(gp_Pnt2d);
+		if (myT->HasNormals())
+			bytes += (size_t)myT->NbNodes() * 3 * sizeof(float);
+
+		m_triangulationBytes += bytes;
+	}
+}
+
+json MemoryReport::GetJson(void) const {
+	json stages = json::array();
+	size_t peakWorkingSet = 0;
+	for (const auto& stage : m_stages) {
+		json stageJson = json::object();
+		stageJson["name"] = stage.name;
+		stageJson["seconds"] = stage.seconds;
+		stageJson["workingSetBytes"] = stage.workingSet;
+		stageJson["peakWorkingSetBytes"] = stage.peakWorkingSet;
+		stageJson["heapUsageBytes"] = stage.heapUsage;
+		stages.push_back(stageJson);
+
+		peakWorkingSet = max(peakWorkingSet, stage.peakWorkingSet);
+	}
+
+	json meshes = json::object();
+	meshes["count"] = m_meshCount;
+	meshes["wideIndexCount"] = m_wideMeshCount;
+	meshes["coordinateBytes"] = m_coordinateBytes;
+	meshes["normalBytes"] = m_normalBytes;
+	meshes["indexBytes"] = m_indexBytes;
+	meshes["edgeBytes"] = m_edgeBytes;
+
+	json report = json::object();
+	report["inputBytes"] = m_inputBytes;
+	report["peakWorkingSetBytes"] = peakWorkingSet;
+	report["peakPerStage"] = m_isPeakPerStage;
+	report["stages"] = stages;
+	report["meshes"] = meshes;
+	report["triangulationBytes"] = m_triangulationBytes;
+	report["arenaBytes"] = m_arenaBytes;
+
+	return report;
+}
+
+void MemoryReport::Print(void) const {
+	auto toMegaBytes = [](size_t bytes) {
+		return bytes / (1024.0 * 1024.0);
+	};
+
+	cout << "\tMemory report (MB)" << (m_isPeakPerStage ? "" : ", peaks since the process started") << endl;
+	cout << fixed << setprecision(1);
+
+	size_t peakWorkingSet = 0;
+	for (const auto& stage : m_stages) {
+		cout << "\t  " << left << setw(12) << stage.name << right
+			 << " working set " << setw(8) << toMegaBytes(stage.workingSet)
+			 << "  peak " << setw(8) << toMegaBytes(stage.peakWorkingSet)
+			 << "  heap " << setw(8) << toMegaBytes(stage.heapUsage) << endl;
+
+		peakWorkingSet = max(peakWorkingSet, stage.peakWorkingSet);
+	}
+
+	cout << "\t  Meshes: coordinates " << toMegaBytes(m_coordinateBytes) << ", normals " << toMegaBytes(m_normalBytes)
+		 << ", indexes " << toMegaBytes(m_indexBytes) << ", edges " << toMegaBytes(m_edgeBytes) << endl;
+	cout << "\t  Meshes with 32-bit indexes: " << m_wideMeshCount << " of " << m_meshCount << endl;
+	cout << "\t  Triangulations " << toMegaBytes(m_triangulationBytes) << ", arena " << toMegaBytes(m_arenaBytes) << endl;
+
+	if (m_inputBytes > 0)
+		cout << "\t  Peak per input byte: " << (double)peakWorkingSet / m_inputBytes << endl;
+
+	cout << defaultfloat << setprecision(6);
+}
+
+size_t MemoryReport::GetMemory(OSD_MemInfo::Counter counter) {
+	OSD_MemInfo memInfo(false);
+	memInfo.SetActive(counter, true);
+	memInfo.Update();
+
+	// Counters the platform cannot read are left at -1
+	size_t value = memInfo.Value(counter);
+	return value == (size_t)-1 ? 0 : value;
+}
+
+bool MemoryReport::ResetPeak(void) {
+#ifdef __linux__
+	// Writing 5 resets VmHWM to the current working set since Linux 4.0
+	ofstream ofs("/proc/self/clear_refs");
+	if (!ofs.is_open())
+		return false;
+
+	ofs << "5";
+	ofs.close();
+	return !ofs.fail();
+#else
+	return false;
+#endif
+}
\ No newline at end of file
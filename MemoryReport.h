@@ -0,0 +1,55 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+using json = nlohmann::json;
+
+// Memory of the process at the end of one stage
+struct MemoryStage {
+	string name;
+	double seconds = 0.0;
+	size_t workingSet = 0;
+	size_t peakWorkingSet = 0;	// Since the stage began, or since the process started where the peak cannot be reset
+	size_t heapUsage = 0;		// Heap in use, includes what Standard::Allocate took from malloc
+};
+
+// Working set high-water marks per stage and the bytes held by the meshes, triangulations and arena of a model,
+// written with --mem-report to size memory limits from the input size
+class MemoryReport {
+public:
+	MemoryReport(void);
+	~MemoryReport(void);
+
+	// Take the input size and begin the first stage
+	void Start(const filesystem::path& inputPath);
+	void EndStage(const string& name);
+
+	// Count the bytes of the tessellated model
+	void AddModel(Model* model);
+
+	json GetJson(void) const;
+	void Print(void) const;
+
+	static size_t GetMemory(OSD_MemInfo::Counter counter);
+
+	// Restart the peak working set, false if the platform keeps one peak per process
+	static bool ResetPeak(void);
+
+protected:
+
+	void AddTriangulations(const TopoDS_Shape& shape, TopTools_IndexedMapOfShape& faceMap);
+
+private:
+	size_t m_inputBytes;
+	bool m_isPeakPerStage;
+	chrono::steady_clock::time_point m_stageStart;
+	vector<MemoryStage> m_stages;
+
+	int m_meshCount;
+	int m_wideMeshCount;	// Meshes with 32-bit triangle indexes
+	size_t m_coordinateBytes;
+	size_t m_normalBytes;
+	size_t m_indexBytes;
+	size_t m_edgeBytes;
+	size_t m_triangulationBytes;	// Poly_Triangulation nodes, UVs, normals and triangles
+	size_t m_arenaBytes;
+};
\ No newline at end of file
@@ -2,39 +2,113 @@
 #include "Mesh.h"
 
 
-Mesh::Mesh(const TopoDS_Shape& shape)
-	: m_shape(shape) {}
+Mesh::Mesh(const TopoDS_Shape& shape, pmr::memory_resource* resource)
+	: m_shape(shape),
+	m_coordinates(resource),
+	m_normals(resource),
+	m_faceIndexes(resource),
+	m_normalIndexes(resource),
+	m_edgeIndexes(resource),
+	m_edgeEnds(resource),
+	m_edgePerimeters(resource),
+	m_perimeter(0.0),
+	m_isDegraded(false) {}
 
 Mesh::~Mesh(void) {
 	Clear();
 }
 
-void Mesh::AddFaceIndex(int v1, int v2, int v3) {
-	Index m_index;
-	m_index.push_back(v1);
-	m_index.push_back(v2);
-	m_index.push_back(v3);
+gp_XYZ* Mesh::AddCoordinates(int count) {
+	size_t size = m_coordinates.size();
+	m_coordinates.resize(size + count);
 
-	m_faceIndexes.push_back(m_index);
+	return m_coordinates.data() + size;
 }
 
-void Mesh::AddNormalIndex(int v1, int v2, int v3) {
-	Index m_index;
-	m_index.push_back(v1);
-	m_index.push_back(v2);
-	m_index.push_back(v3);
+void Mesh::Reserve(int nodeCount, int triangleCount) {
+	m_coordinates.reserve(nodeCount);
+	m_faceIndexes.Reserve(3 * triangleCount, nodeCount);
+}
 
-	m_normalIndexes.push_back(m_index);
+void Mesh::ReserveNormals(int normalCount, int triangleCount) {
+	m_normals.reserve(normalCount);
+	m_normalIndexes.Reserve(3 * triangleCount, normalCount);
 }
 
-void Mesh::AddEdgeIndex(Index edgeIndex) {
-	m_edgeIndexes.push_back(edgeIndex);
+void Mesh::AddFaceIndex(int v1, int v2, int v3) {
+	m_faceIndexes.Add(v1);
+	m_faceIndexes.Add(v2);
+	m_faceIndexes.Add(v3);
+}
+
+void Mesh::AddNormalIndex(int v1, int v2, int v3) {
+	m_normalIndexes.Add(v1);
+	m_normalIndexes.Add(v2);
+	m_normalIndexes.Add(v3);
+}
+
+void Mesh::AddEdgeIndex(const vector<int>& edgeIndex) {
+	for (int index : edgeIndex)
+		m_edgeIndexes.Add(index);
+
+	m_edgeEnds.push_back(m_edgeIndexes.GetSize());
 }
 
 void Mesh::AddEdgePerimeter(double edgePerimeter) {
 	m_edgePerimeters.push_back(edgePerimeter);
 }
 
+void Mesh::ReorderFaces(const vector<int>& order) {
+	ReorderTriangles(m_faceIndexes, order);
+
+	// Normal indexes follow their triangles
+	if (m_normalIndexes.GetSize() > 0)
+		ReorderTriangles(m_normalIndexes, order);
+}
+
+void Mesh::ReorderTriangles(IndexBuffer& indexes, const vector<int>& order) {
+	// Same width as before, the largest index does not change
+	IndexBuffer reordered(indexes.GetResource());
+	reordered.Reserve(indexes.GetSize(), indexes.IsWide() ? numeric_limits<int>::max() : 0);
+
+	for (int index : order) {
+		for (int k = 0; k < 3; ++k)
+			reordered.Add(indexes[3 * index + k]);
+	}
+
+	indexes.Swap(reordered);
+}
+
+void Mesh::RemapCoordinates(const vector<int>& newIndex) {
+	pmr::vector<gp_XYZ> coordinates(m_coordinates.size(), m_coordinates.get_allocator());
+
+	for (size_t i = 0; i < m_coordinates.size(); ++i)
+		coordinates[newIndex[i]] = m_coordinates[i];
+
+	m_coordinates.swap(coordinates);
+
+	// Indexes are 1-based
+	RemapIndexes(m_faceIndexes, newIndex);
+	RemapIndexes(m_edgeIndexes, newIndex);
+}
+
+void Mesh::RemapNormals(const vector<int>& newIndex) {
+	pmr::vector<gp_XYZ> normals(m_normals.size(), m_normals.get_allocator());
+
+	for (size_t i = 0; i < m_normals.size(); ++i)
+		normals[newIndex[i]] = m_normals[i];
+
+	m_normals.swap(normals);
+
+	RemapIndexes(m_normalIndexes, newIndex);
+}
+
+void Mesh::RemapIndexes(IndexBuffer& indexes, const vector<int>& newIndex) {
+	// A permutation keeps the largest index, and with it the width
+	for (int i = 0; i < indexes.GetSize(); ++i)
+		indexes.Set(i, newIndex[indexes[i] - 1] + 1);
+}
+
 bool Mesh::IsEmpty(void) const {
 	if (m_coordinates.empty())
 		return true;
@@ -42,19 +116,17 @@ bool Mesh::IsEmpty(void) const {
 	return false;
 }
 
-void Mesh::Clear(void) {
-	for (auto faceIndex : m_faceIndexes)
-		faceIndex.clear();
-
-	for (auto normalIndex : m_normalIndexes)
-		normalIndex.clear();
-
-	for (auto edgeIndex : m_edgeIndexes)
-		edgeIndex.clear();
+size_t Mesh::GetEdgeBytes(void) const {
+	return m_edgeIndexes.GetBytes() + m_edgeEnds.capacity() * sizeof(int) + m_edgePerimeters.capacity() * sizeof(double);
+}
 
-	m_faceIndexes.clear();
-	m_normalIndexes.clear();
-	m_edgeIndexes.clear();
+void Mesh::Clear(void) {
+	// Buffers live in the arena, so clearing only resets the sizes
+	m_faceIndexes.Clear();
+	m_normalIndexes.Clear();
+	m_edgeIndexes.Clear();
+	m_edgeEnds.clear();
+	m_edgePerimeters.clear();
 	m_coordinates.clear();
 	m_normals.clear();
 }
\ No newline at end of file
@@ -1,50 +1,84 @@
 #pragma once
 
-typedef vector<int> Index;
+#include "IndexBuffer.h"
+
+// Nodes of one triangle or edge, a view into the index buffers of a mesh
+typedef IndexRange Index;
 
 class Mesh {
 public:
-	Mesh(const TopoDS_Shape& shape);
+	Mesh(const TopoDS_Shape& shape, pmr::memory_resource* resource = pmr::get_default_resource());
 	~Mesh(void);
 
 	void AddFaceIndex(int v1, int v2, int v3);
 	void AddNormalIndex(int v1, int v2, int v3);
-	void AddEdgeIndex(Index edgeIndex);
+	void AddEdgeIndex(const vector<int>& edgeIndex);
 	void AddEdgePerimeter(double edgePerimeter);
 	void AddCoordinate(const gp_XYZ& coord) { m_coordinates.push_back(coord); }
+
+	// Room for count coordinates at the end, to be filled in place
+	gp_XYZ* AddCoordinates(int count);
 	void AddNormal(const gp_XYZ& norm) { m_normals.push_back(norm); }
 	void SetPerimeter(double& perimeter) { m_perimeter = perimeter; }
+	void SetDegraded(bool isDegraded) { m_isDegraded = isDegraded; }
+
+	// Exact sizes ahead of the Add calls, the node count also fixes the index width
+	void Reserve(int nodeCount, int triangleCount);
+	void ReserveNormals(int normalCount, int triangleCount);
+
+	// Reorder triangles, order[i] is the former position of the i-th triangle
+	void ReorderFaces(const vector<int>& order);
+
+	// Renumber nodes, newIndex[i] is the new 0-based position of the former node i
+	void RemapCoordinates(const vector<int>& newIndex);
+	void RemapNormals(const vector<int>& newIndex);
 
 	const TopoDS_Shape& GetShape(void) const { return m_shape; }
-	const Index& GetFaceIndexAt(int index) const { return m_faceIndexes[index]; }
-	const Index& GetNormalIndexAt(int index) const { return m_normalIndexes[index]; }
-	const Index& GetEdgeIndexAt(int index) const { return m_edgeIndexes[index]; }
+	Index GetFaceIndexAt(int index) const { return Index(m_faceIndexes, 3 * index, 3 * index + 3); }
+	Index GetNormalIndexAt(int index) const { return Index(m_normalIndexes, 3 * index, 3 * index + 3); }
+	Index GetEdgeIndexAt(int index) const { return Index(m_edgeIndexes, index > 0 ? m_edgeEnds[index - 1] : 0, m_edgeEnds[index]); }
 	const double GetEdgePerimeterAt(int index) const { return m_edgePerimeters[index]; }
 	const double GetEdgePerimeter() const { return m_perimeter; }
 	const gp_XYZ& GetCoordinateAt(int index) const { return m_coordinates[index]; }
 	const gp_XYZ& GetNormalAt(int index) const { return m_normals[index]; }
 
-	const int GetFaceIndexSize(void) const { return (int)m_faceIndexes.size(); }
-	const int GetNormalIndexSize(void) const { return (int)m_normalIndexes.size(); }
-	const int GetEdgeIndexSize(void) const { return (int)m_edgeIndexes.size(); }
+	const int GetFaceIndexSize(void) const { return m_faceIndexes.GetSize() / 3; }
+	const int GetNormalIndexSize(void) const { return m_normalIndexes.GetSize() / 3; }
+	const int GetEdgeIndexSize(void) const { return (int)m_edgeEnds.size(); }
 	const int GetEdgePerimeterSize(void) const { return (int)m_edgePerimeters.size(); }
 	const int GetCoordinateSize(void) const { return (int)m_coordinates.size(); }
 	const int GetNormalSize(void) const { return (int)m_normals.size(); }
 
+	// Bytes reserved by the buffers, for the memory report
+	size_t GetCoordinateBytes(void) const { return m_coordinates.capacity() * sizeof(gp_XYZ); }
+	size_t GetNormalBytes(void) const { return m_normals.capacity() * sizeof(gp_XYZ); }
+	size_t GetIndexBytes(void) const { return m_faceIndexes.GetBytes() + m_normalIndexes.GetBytes(); }
+	size_t GetEdgeBytes(void) const;
+
+	// Triangle indexes, 16 bits wide while the mesh has at most 65535 nodes
+	const IndexBuffer& GetFaceIndexes(void) const { return m_faceIndexes; }
+
 	bool IsEmpty(void) const;
+	bool IsDegraded(void) const { return m_isDegraded; }	// Meshed coarser than requested to stay within a budget
 
 protected:
 	void Clear(void);
 
+	static void ReorderTriangles(IndexBuffer& indexes, const vector<int>& order);
+	static void RemapIndexes(IndexBuffer& indexes, const vector<int>& newIndex);
+
 private:
 	TopoDS_Shape m_shape;
 
-	vector<gp_XYZ> m_coordinates;
-	vector<gp_XYZ> m_normals;
+	// All buffers are allocated from the owning Model's arena
+	pmr::vector<gp_XYZ> m_coordinates;
+	pmr::vector<gp_XYZ> m_normals;
 
-	vector<Index> m_faceIndexes;
-	vector<Index> m_normalIndexes;
-	vector<Index> m_edgeIndexes;
-	vector<double> m_edgePerimeters;
+	IndexBuffer m_faceIndexes;		// Three nodes per triangle
+	IndexBuffer m_normalIndexes;	// Three normals per triangle
+	IndexBuffer m_edgeIndexes;		// Nodes of all edge polylines, one after the other
+	pmr::vector<int> m_edgeEnds;	// End of each polyline in m_edgeIndexes
+	pmr::vector<double> m_edgePerimeters;
 	double m_perimeter;
+	bool m_isDegraded;
 };
\ No newline at end of file
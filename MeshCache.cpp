@@ -0,0 +1,273 @@
+#include "CommonImport.h"
+#include "MeshCache.h"
+#include "ShapeFingerprint.h"
+#include "Mesh.h"
+#include <fstream>
+
+namespace fs = std::filesystem;
+
+// File layout version, entries of another version are ignored
+constexpr uint64_t CACHE_MAGIC = 0x3348534d50545350ULL;	// "STPMSH3"
+
+template<typename T>
+static void WriteValue(ostream& os, const T& value) {
+	os.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template<typename T>
+static bool ReadValue(istream& is, T& value) {
+	is.read(reinterpret_cast<char*>(&value), sizeof(T));
+	return (bool)is;
+}
+
+MeshCache::MeshCache(const wstring& directory, double massTolerance)
+	: m_directory(directory),
+	m_massTolerance(massTolerance),
+	m_missCount(0),
+	m_storeCount(0) {
+	error_code ec;
+	fs::create_directories(m_directory, ec);
+}
+
+MeshCache::~MeshCache(void) {
+	Clear();
+}
+
+bool MeshCache::Load(const TopoDS_Shape& solid, uint64_t fingerprint, const IMeshTools_Parameters& parameters) {
+	// Solids already looked up
+	if (IsCached(solid))
+		return true;
+
+	if (IsPending(solid))
+		return false;
+
+	if (LoadEntry(solid, fingerprint, parameters))
+		return true;
+
+	m_missCount++;
+	m_pendingMap.Bind(solid, (int)m_pendingKeys.size());
+	m_pendingKeys.push_back(make_pair(fingerprint, parameters));
+
+	return false;
+}
+
+bool MeshCache::LoadEntry(const TopoDS_Shape& solid, uint64_t fingerprint, const IMeshTools_Parameters& parameters) {
+	ifstream ifs(GetFilePath(fingerprint), ios::binary);
+	if (!ifs.is_open())
+		return false;
+
+	// The fingerprint guards against a truncated name, the parameters against a changed deflection
+	uint64_t magic = 0, storedFingerprint = 0;
+	double deflection = 0.0, angle = 0.0, massTolerance = 0.0;
+	double volume = 0.0, area = 0.0;
+	gp_XYZ centerOfMass;
+	gp_Mat inertia;
+	bool isRelative = false;
+	int faceCount = 0;
+
+	if (!ReadValue(ifs, magic)
+		|| magic != CACHE_MAGIC
+		|| !ReadValue(ifs, storedFingerprint)
+		|| storedFingerprint != fingerprint
+		|| !ReadValue(ifs, deflection)
+		|| !ReadValue(ifs, angle)
+		|| !ReadValue(ifs, isRelative)
+		|| deflection != parameters.Deflection
+		|| angle != parameters.Angle
+		|| isRelative != (bool)parameters.Relative
+		|| !ReadValue(ifs, massTolerance)
+		|| massTolerance != m_massTolerance
+		|| !ReadValue(ifs, volume)
+		|| !ReadValue(ifs, area)
+		|| !ReadValue(ifs, centerOfMass)
+		|| !ReadValue(ifs, inertia)
+		|| !ReadValue(ifs, faceCount))
+		return false;
+
+	vector<CachedFace> faces(max(0, faceCount));
+	for (auto& face : faces) {
+		int coordCount = 0, triangleCount = 0, edgeCount = 0;
+		bool isWide = false;
+
+		if (!ReadValue(ifs, face.hasMesh))
+			break;
+
+		if (!face.hasMesh)
+			continue;
+
+		ReadValue(ifs, coordCount);
+		face.coordinates.resize(max(0, coordCount));
+		ifs.read(reinterpret_cast<char*>(face.coordinates.data()), face.coordinates.size() * sizeof(gp_XYZ));
+
+		ReadValue(ifs, triangleCount);
+		ReadValue(ifs, isWide);
+		face.faceIndexes.Resize(3 * max(0, triangleCount), isWide);
+		ifs.read(reinterpret_cast<char*>(face.faceIndexes.GetData()), (size_t)face.faceIndexes.GetSize() * face.faceIndexes.GetWidth());
+
+		ReadValue(ifs, edgeCount);
+		face.edgeIndexes.resize(max(0, edgeCount));
+		face.edgePerimeters.resize(max(0, edgeCount));
+		for (int i = 0; i < edgeCount && ifs; ++i) {
+			int nodeCount = 0;
+			ReadValue(ifs, nodeCount);
+			face.edgeIndexes[i].resize(max(0, nodeCount));
+			ifs.read(reinterpret_cast<char*>(face.edgeIndexes[i].data()), face.edgeIndexes[i].size() * sizeof(int));
+			ReadValue(ifs, face.edgePerimeters[i]);
+		}
+
+		ReadValue(ifs, face.perimeter);
+	}
+
+	// Faces are matched by their order, which the fingerprint already depends on
+	vector<TopoDS_Shape> solidFaces;
+	TopExp_Explorer ExpFace;
+	for (ExpFace.Init(solid, TopAbs_FACE); ExpFace.More(); ExpFace.Next())
+		solidFaces.push_back(ExpFace.Current());
+
+	if (!ifs
+		|| solidFaces.size() != faces.size())
+		return false;
+
+	for (int i = 0; i < (int)solidFaces.size(); ++i)
+		m_faceMap.Bind(solidFaces[i], (int)m_faces.size() + i);
+
+	m_faces.insert(m_faces.end(), make_move_iterator(faces.begin()), make_move_iterator(faces.end()));
+
+	MassProperties massProperties;
+	massProperties.Set(volume, area, centerOfMass, inertia);
+
+	m_solidMap.Bind(solid, (int)m_massPropertiesList.size());
+	m_massPropertiesList.push_back(massProperties);
+
+	return true;
+}
+
+bool MeshCache::Store(const TopoDS_Shape& solid, const MassProperties& massProperties, const vector<Mesh*>& faceMeshes) {
+	if (!IsPending(solid))
+		return false;
+
+	uint64_t fingerprint = m_pendingKeys[m_pendingMap.Find(solid)].first;
+	const IMeshTools_Parameters& parameters = m_pendingKeys[m_pendingMap.Find(solid)].second;
+	m_pendingMap.UnBind(solid);
+
+	fs::path filePath = GetFilePath(fingerprint);
+	fs::path tempPath = filePath;
+	tempPath += ".tmp";
+
+	ofstream ofs(tempPath, ios::binary);
+	if (!ofs.is_open())
+		return false;
+
+	WriteValue(ofs, CACHE_MAGIC);
+	WriteValue(ofs, fingerprint);
+	WriteValue(ofs, parameters.Deflection);
+	WriteValue(ofs, parameters.Angle);
+	WriteValue(ofs, (bool)parameters.Relative);
+	WriteValue(ofs, m_massTolerance);
+	WriteValue(ofs, massProperties.GetVolume());
+	WriteValue(ofs, massProperties.GetArea());
+	WriteValue(ofs, massProperties.GetCenterOfMass());
+	WriteValue(ofs, massProperties.GetInertia());
+	WriteValue(ofs, (int)faceMeshes.size());
+
+	for (const auto& mesh : faceMeshes) {
+		WriteValue(ofs, mesh != nullptr);
+
+		if (!mesh)
+			continue;
+
+		WriteValue(ofs, mesh->GetCoordinateSize());
+		for (int i = 0; i < mesh->GetCoordinateSize(); ++i)
+			WriteValue(ofs, mesh->GetCoordinateAt(i));
+
+		// Triangle indexes keep their width, mostly 16 bits
+		const IndexBuffer& faceIndexes = mesh->GetFaceIndexes();
+		WriteValue(ofs, mesh->GetFaceIndexSize());
+		WriteValue(ofs, faceIndexes.IsWide());
+		ofs.write(reinterpret_cast<const char*>(faceIndexes.GetData()), (size_t)faceIndexes.GetSize() * faceIndexes.GetWidth());
+
+		WriteValue(ofs, mesh->GetEdgeIndexSize());
+		for (int i = 0; i < mesh->GetEdgeIndexSize(); ++i) {
+			const Index& edgeIndex = mesh->GetEdgeIndexAt(i);
+			WriteValue(ofs, (int)edgeIndex.size());
+			for (int index : edgeIndex)
+				WriteValue(ofs, index);
+			WriteValue(ofs, i < mesh->GetEdgePerimeterSize() ? mesh->GetEdgePerimeterAt(i) : 0.0);
+		}
+
+		WriteValue(ofs, mesh->GetEdgePerimeter());
+	}
+
+	ofs.close();
+
+	// Readers of a shared directory only ever see complete entries
+	error_code ec;
+	if (ofs.fail()) {
+		fs::remove(tempPath, ec);
+		return false;
+	}
+
+	fs::rename(tempPath, filePath, ec);
+	if (ec) {
+		fs::remove(tempPath, ec);
+		return false;
+	}
+
+	m_storeCount++;
+	return true;
+}
+
+bool MeshCache::IsCached(const TopoDS_Shape& shape) const {
+	return m_faceMap.IsBound(shape)
+		|| m_solidMap.IsBound(shape);
+}
+
+const MassProperties& MeshCache::GetMassProperties(const TopoDS_Shape& solid) const {
+	return m_massPropertiesList[m_solidMap.Find(solid)];
+}
+
+Mesh* MeshCache::GetMeshForFace(const TopoDS_Face& face, Arena& arena) const {
+	if (!m_faceMap.IsBound(face))
+		return nullptr;
+
+	const CachedFace& cachedFace = m_faces[m_faceMap.Find(face)];
+	if (!cachedFace.hasMesh)
+		return nullptr;
+
+	Mesh* mesh = arena.New<Mesh>(face, &arena);
+	mesh->Reserve((int)cachedFace.coordinates.size(), cachedFace.faceIndexes.GetSize() / 3);
+
+	copy(cachedFace.coordinates.begin(), cachedFace.coordinates.end(), mesh->AddCoordinates((int)cachedFace.coordinates.size()));
+
+	for (int i = 0; i + 2 < cachedFace.faceIndexes.GetSize(); i += 3)
+		mesh->AddFaceIndex(cachedFace.faceIndexes[i], cachedFace.faceIndexes[i + 1], cachedFace.faceIndexes[i + 2]);
+
+	for (int i = 0; i < (int)cachedFace.edgeIndexes.size(); ++i) {
+		mesh->AddEdgeIndex(cachedFace.edgeIndexes[i]);
+		mesh->AddEdgePerimeter(cachedFace.edgePerimeters[i]);
+	}
+
+	double perimeter = cachedFace.perimeter;
+	mesh->SetPerimeter(perimeter);
+
+	return mesh;
+}
+
+void MeshCache::Print(void) const {
+	cout << "Mesh cache" << endl;
+	cout << "\tReused solids: " << m_massPropertiesList.size() << " of " << m_massPropertiesList.size() + m_missCount << endl;
+	cout << "\tStored solids: " << m_storeCount << endl;
+}
+
+const fs::path MeshCache::GetFilePath(uint64_t fingerprint) const {
+	return m_directory / (ShapeFingerprint::ToString(fingerprint) + ".mesh");
+}
+
+void MeshCache::Clear(void) {
+	m_faces.clear();
+	m_massPropertiesList.clear();
+	m_faceMap.Clear();
+	m_solidMap.Clear();
+	m_pendingKeys.clear();
+	m_pendingMap.Clear();
+}
\ No newline at end of file
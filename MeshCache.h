@@ -0,0 +1,58 @@
+#pragma once
+
+#include "MassProperties.h"
+#include "IndexBuffer.h"
+
+class Mesh;
+
+// Face meshes and mass properties of solids keyed by their ShapeFingerprint, one file per solid in a cache directory.
+// Solids of a revised model with an unchanged fingerprint and meshing parameters skip meshing and measuring.
+class MeshCache {
+public:
+	MeshCache(const wstring& directory, double massTolerance);
+	~MeshCache(void);
+
+	// Look up the entry of a solid, its faces are then served from the cache.
+	// On a miss the key is kept so that the solid can be stored once it is meshed.
+	bool Load(const TopoDS_Shape& solid, uint64_t fingerprint, const IMeshTools_Parameters& parameters);
+
+	// Write the entry of a missed solid, faceMeshes in explorer order with nullptr for unmeshed faces
+	bool Store(const TopoDS_Shape& solid, const MassProperties& massProperties, const vector<Mesh*>& faceMeshes);
+
+	bool IsCached(const TopoDS_Shape& shape) const;
+	bool IsPending(const TopoDS_Shape& solid) const { return m_pendingMap.IsBound(solid); }
+	const MassProperties& GetMassProperties(const TopoDS_Shape& solid) const;
+	Mesh* GetMeshForFace(const TopoDS_Face& face, Arena& arena) const;
+
+	void Print(void) const;
+
+protected:
+	struct CachedFace {
+		bool hasMesh = false;
+		vector<gp_XYZ> coordinates;
+		IndexBuffer faceIndexes;	// Three 1-based nodes per triangle
+		vector<vector<int>> edgeIndexes;
+		vector<double> edgePerimeters;
+		double perimeter = 0.0;
+	};
+
+	bool LoadEntry(const TopoDS_Shape& solid, uint64_t fingerprint, const IMeshTools_Parameters& parameters);
+	const filesystem::path GetFilePath(uint64_t fingerprint) const;
+
+	void Clear(void);
+
+private:
+	filesystem::path m_directory;
+	double m_massTolerance;		// Part of the key, the mass properties depend on it
+
+	vector<CachedFace> m_faces;
+	vector<MassProperties> m_massPropertiesList;	// Mass properties of each loaded solid
+	TopTools_DataMapOfShapeInteger m_faceMap;	// Face to its position in m_faces
+	TopTools_DataMapOfShapeInteger m_solidMap;	// Solid to its position in m_massPropertiesList
+
+	vector<pair<uint64_t, IMeshTools_Parameters>> m_pendingKeys;	// Fingerprint and parameters of each missed solid
+	TopTools_DataMapOfShapeInteger m_pendingMap;	// Missed solid to its position in m_pendingKeys
+
+	int m_missCount;
+	int m_storeCount;
+};
\ No newline at end of file
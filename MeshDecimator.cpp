@@ -0,0 +1,382 @@
+#include "CommonImport.h"
+#include "MeshDecimator.h"
+#include "Mesh.h"
+
+// Sharper folds between the triangles of a face are kept
+const double FEATURE_ANGLE_COS = cos(60.0 * PI / 180.0);
+
+// Smallest cosine allowed between a triangle normal before and after a collapse
+constexpr double FLIP_COS = 0.2;
+
+// Shape quality (1 for an equilateral triangle) below which a collapse may not thin a triangle further
+constexpr double MIN_QUALITY = 0.05;
+
+double GetTriangleQuality(const gp_XYZ points[3], double doubleArea) {
+	double edgeSum = (points[1] - points[0]).SquareModulus()
+		+ (points[2] - points[1]).SquareModulus()
+		+ (points[0] - points[2]).SquareModulus();
+
+	return edgeSum > 0.0 ? 2.0 * sqrt(3.0) * doubleArea / edgeSum : 0.0;
+}
+
+void Quadric::AddPlane(const gp_XYZ& normal, double d, double weight) {
+	double x = normal.X(), y = normal.Y(), z = normal.Z();
+
+	a[0] += weight * x * x;
+	a[1] += weight * x * y;
+	a[2] += weight * x * z;
+	a[3] += weight * x * d;
+	a[4] += weight * y * y;
+	a[5] += weight * y * z;
+	a[6] += weight * y * d;
+	a[7] += weight * z * z;
+	a[8] += weight * z * d;
+	a[9] += weight * d * d;
+}
+
+void Quadric::Add(const Quadric& q) {
+	for (int i = 0; i < 10; ++i)
+		a[i] += q.a[i];
+}
+
+double Quadric::Evaluate(const gp_XYZ& p) const {
+	double x = p.X(), y = p.Y(), z = p.Z();
+
+	return a[0] * x * x + 2.0 * a[1] * x * y + 2.0 * a[2] * x * z + 2.0 * a[3] * x
+		+ a[4] * y * y + 2.0 * a[5] * y * z + 2.0 * a[6] * y
+		+ a[7] * z * z + 2.0 * a[8] * z
+		+ a[9];
+}
+
+MeshDecimator::MeshDecimator(void)
+	: m_triangleCount(0) {}
+
+MeshDecimator::~MeshDecimator(void) {}
+
+Mesh* MeshDecimator::Decimate(const Mesh* mesh, double ratio, Arena& arena) {
+	Initialize(mesh);
+
+	int targetCount = max(1, (int)(m_triangleCount * ratio));
+
+	for (int v = 0; v < (int)m_positions.size(); ++v)
+		PushEdges(v);
+
+	while (m_triangleCount > targetCount
+		   && !m_heap.empty()) {
+		EdgeCost edge = m_heap.top();
+		m_heap.pop();
+
+		// Skip costs computed before one of the vertices changed
+		if (edge.fromStamp != m_stamps[edge.from]
+			|| edge.toStamp != m_stamps[edge.to])
+			continue;
+
+		if (!CanCollapse(edge.from, edge.to, edge.position))
+			continue;
+
+		Collapse(edge.from, edge.to, edge.position);
+	}
+
+	m_heap = decltype(m_heap)();
+
+	return GetMesh(mesh, arena);
+}
+
+void MeshDecimator::Initialize(const Mesh* mesh) {
+	int vertexCount = mesh->GetCoordinateSize();
+
+	m_positions.assign(vertexCount, gp_XYZ());
+	m_quadrics.assign(vertexCount, Quadric());
+	m_isLocked.assign(vertexCount, false);
+	m_stamps.assign(vertexCount, 0);
+	m_vertexTriangles.assign(vertexCount, vector<int>());
+	m_triangles.clear();
+
+	for (int i = 0; i < vertexCount; ++i)
+		m_positions[i] = mesh->GetCoordinateAt(i);
+
+	// Triangles with 0-based indexes and their unit normals
+	vector<gp_XYZ> normals;
+	for (int i = 0; i < mesh->GetFaceIndexSize(); ++i) {
+		const Index& faceIndex = mesh->GetFaceIndexAt(i);
+		array<int, 3> triangle = { faceIndex[0] - 1, faceIndex[1] - 1, faceIndex[2] - 1 };
+
+		const gp_XYZ& p1 = m_positions[triangle[0]];
+		gp_XYZ normal = (m_positions[triangle[1]] - p1).Crossed(m_positions[triangle[2]] - p1);
+		double area = normal.Modulus() / 2.0;
+
+		if (area <= 0.0)
+			normal = gp_XYZ(0.0, 0.0, 0.0);
+		else
+			normal /= 2.0 * area;
+
+		// Area weighted plane of the triangle
+		for (int v : triangle) {
+			m_quadrics[v].AddPlane(normal, -normal.Dot(p1), area);
+			m_vertexTriangles[v].push_back((int)m_triangles.size());
+		}
+
+		m_triangles.push_back(triangle);
+		normals.push_back(normal);
+	}
+
+	m_isRemoved.assign(m_triangles.size(), false);
+	m_triangleCount = (int)m_triangles.size();
+
+	// Triangles on each edge, to find the boundary, non-manifold and feature edges
+	unordered_map<long long, vector<int>> edgeTriangles;
+	for (int i = 0; i < (int)m_triangles.size(); ++i) {
+		for (int k = 0; k < 3; ++k) {
+			int v1 = m_triangles[i][k];
+			int v2 = m_triangles[i][(k + 1) % 3];
+			long long key = (long long)min(v1, v2) * vertexCount + max(v1, v2);
+			edgeTriangles[key].push_back(i);
+		}
+	}
+
+	for (const auto& edge : edgeTriangles) {
+		const vector<int>& triangles = edge.second;
+
+		bool isLocked = triangles.size() != 2
+			|| normals[triangles[0]].Dot(normals[triangles[1]]) < FEATURE_ANGLE_COS;
+
+		if (isLocked) {
+			m_isLocked[(int)(edge.first / vertexCount)] = true;
+			m_isLocked[(int)(edge.first % vertexCount)] = true;
+		}
+	}
+
+	// Nodes of the B-rep edges stay where they are so that neighbor faces still meet
+	for (int i = 0; i < mesh->GetEdgeIndexSize(); ++i) {
+		for (int index : mesh->GetEdgeIndexAt(i))
+			m_isLocked[index - 1] = true;
+	}
+}
+
+void MeshDecimator::PushEdges(int v) {
+	unordered_set<int> neighbors;
+	for (int t : m_vertexTriangles[v]) {
+		if (m_isRemoved[t])
+			continue;
+
+		for (int w : m_triangles[t]) {
+			if (w != v)
+				neighbors.insert(w);
+		}
+	}
+
+	for (int w : neighbors) {
+		if (m_isLocked[v]
+			&& m_isLocked[w])
+			continue;
+
+		Quadric q = m_quadrics[v];
+		q.Add(m_quadrics[w]);
+
+		EdgeCost edge;
+
+		// A locked vertex keeps its position, otherwise pick the best of both ends and the midpoint
+		if (m_isLocked[v]) {
+			edge.from = w;
+			edge.to = v;
+			edge.position = m_positions[v];
+		} else if (m_isLocked[w]) {
+			edge.from = v;
+			edge.to = w;
+			edge.position = m_positions[w];
+		} else {
+			edge.from = v;
+			edge.to = w;
+			edge.position = m_positions[w];
+
+			gp_XYZ candidates[2] = { m_positions[v], (m_positions[v] + m_positions[w]) / 2.0 };
+			for (const auto& candidate : candidates) {
+				if (q.Evaluate(candidate) < q.Evaluate(edge.position))
+					edge.position = candidate;
+			}
+		}
+
+		edge.cost = max(0.0, q.Evaluate(edge.position));
+		edge.fromStamp = m_stamps[edge.from];
+		edge.toStamp = m_stamps[edge.to];
+
+		m_heap.push(edge);
+	}
+}
+
+bool MeshDecimator::CanCollapse(int from, int to, const gp_XYZ& position) const {
+	// Link condition: the ends may only share the vertices of the triangles on the edge
+	unordered_set<int> fromNeighbors;
+	int sharedTriangles = 0;
+	for (int t : m_vertexTriangles[from]) {
+		if (m_isRemoved[t])
+			continue;
+
+		const array<int, 3>& triangle = m_triangles[t];
+		if (triangle[0] == to || triangle[1] == to || triangle[2] == to)
+			sharedTriangles++;
+
+		for (int w : triangle)
+			fromNeighbors.insert(w);
+	}
+
+	unordered_set<int> commonNeighbors;
+	for (int t : m_vertexTriangles[to]) {
+		if (m_isRemoved[t])
+			continue;
+
+		for (int w : m_triangles[t]) {
+			if (w != from
+				&& w != to
+				&& fromNeighbors.count(w))
+				commonNeighbors.insert(w);
+		}
+	}
+
+	if ((int)commonNeighbors.size() != sharedTriangles)
+		return false;
+
+	// Triangles that remain must not flip or degenerate
+	for (int v : { from, to }) {
+		for (int t : m_vertexTriangles[v]) {
+			if (m_isRemoved[t])
+				continue;
+
+			const array<int, 3>& triangle = m_triangles[t];
+			if ((triangle[0] == from || triangle[1] == from || triangle[2] == from)
+				&& (triangle[0] == to || triangle[1] == to || triangle[2] == to))
+				continue;
+
+			gp_XYZ oldPoints[3], newPoints[3];
+			for (int k = 0; k < 3; ++k) {
+				oldPoints[k] = m_positions[triangle[k]];
+				newPoints[k] = triangle[k] == v ? position : oldPoints[k];
+			}
+
+			gp_XYZ oldNormal = (oldPoints[1] - oldPoints[0]).Crossed(oldPoints[2] - oldPoints[0]);
+			gp_XYZ newNormal = (newPoints[1] - newPoints[0]).Crossed(newPoints[2] - newPoints[0]);
+
+			double newModulus = newNormal.Modulus();
+			if (newModulus <= Precision::SquareConfusion())
+				return false;
+
+			double oldModulus = oldNormal.Modulus();
+			if (oldNormal.Dot(newNormal) < FLIP_COS * oldModulus * newModulus)
+				return false;
+
+			// Slivers are tolerated as long as a collapse does not produce new ones
+			double newQuality = GetTriangleQuality(newPoints, newModulus);
+			if (newQuality < MIN_QUALITY
+				&& newQuality < GetTriangleQuality(oldPoints, oldModulus))
+				return false;
+		}
+	}
+
+	return true;
+}
+
+void MeshDecimator::Collapse(int from, int to, const gp_XYZ& position) {
+	for (int t : m_vertexTriangles[from]) {
+		if (m_isRemoved[t])
+			continue;
+
+		array<int, 3>& triangle = m_triangles[t];
+
+		// Triangles on the collapsed edge disappear, the others move to the kept vertex
+		if (triangle[0] == to || triangle[1] == to || triangle[2] == to) {
+			m_isRemoved[t] = true;
+			m_triangleCount--;
+			continue;
+		}
+
+		for (int& v : triangle) {
+			if (v == from)
+				v = to;
+		}
+
+		m_vertexTriangles[to].push_back(t);
+	}
+
+	m_vertexTriangles[from].clear();
+
+	// Drop the removed triangles of the kept vertex
+	vector<int>& toTriangles = m_vertexTriangles[to];
+	toTriangles.erase(remove_if(toTriangles.begin(), toTriangles.end(), [this](int t) {
+		return m_isRemoved[t];
+	}), toTriangles.end());
+
+	m_positions[to] = position;
+	m_quadrics[to].Add(m_quadrics[from]);
+
+	m_stamps[from]++;
+	m_stamps[to]++;
+
+	PushEdges(to);
+}
+
+Mesh* MeshDecimator::GetMesh(const Mesh* mesh, Arena& arena) const {
+	Mesh* lodMesh = arena.New<Mesh>(mesh->GetShape(), &arena);
+
+	// Count the remaining triangles and their vertices, so the arena buffers get their exact size
+	vector<bool> isUsed(m_positions.size(), false);
+	int usedCount = 0;
+	int triangleCount = 0;
+	for (int i = 0; i < (int)m_triangles.size(); ++i) {
+		if (m_isRemoved[i])
+			continue;
+
+		triangleCount++;
+		for (int k = 0; k < 3; ++k) {
+			if (!isUsed[m_triangles[i][k]]) {
+				isUsed[m_triangles[i][k]] = true;
+				usedCount++;
+			}
+		}
+	}
+	lodMesh->Reserve(usedCount, triangleCount);
+
+	// Keep only the vertices of the remaining triangles, 1-based like the source
+	vector<int> newIndex(m_positions.size(), 0);
+	int vertexCount = 0;
+
+	for (int i = 0; i < (int)m_triangles.size(); ++i) {
+		if (m_isRemoved[i])
+			continue;
+
+		int indexes[3] = { 0 };
+		for (int k = 0; k < 3; ++k) {
+			int v = m_triangles[i][k];
+
+			if (newIndex[v] == 0) {
+				lodMesh->AddCoordinate(m_positions[v]);
+				newIndex[v] = ++vertexCount;
+			}
+
+			indexes[k] = newIndex[v];
+		}
+
+		lodMesh->AddFaceIndex(indexes[0], indexes[1], indexes[2]);
+	}
+
+	// Edge polyline nodes are locked, so the outlines carry over unchanged
+	for (int i = 0; i < mesh->GetEdgeIndexSize(); ++i) {
+		const Index& edgeIndex = mesh->GetEdgeIndexAt(i);
+
+		vector<int> lodEdgeIndex;
+		for (const auto& index : edgeIndex) {
+			if (newIndex[index - 1] > 0)
+				lodEdgeIndex.push_back(newIndex[index - 1]);
+		}
+
+		if (lodEdgeIndex.size() < 2)
+			continue;
+
+		lodMesh->AddEdgeIndex(lodEdgeIndex);
+		lodMesh->AddEdgePerimeter(mesh->GetEdgePerimeterAt(i));
+	}
+
+	double perimeter = mesh->GetEdgePerimeter();
+	lodMesh->SetPerimeter(perimeter);
+
+	return lodMesh;
+}
\ No newline at end of file
@@ -0,0 +1,53 @@
+#pragma once
+
+class Mesh;
+
+// Symmetric 4x4 error quadric of Garland and Heckbert, upper triangle only
+struct Quadric {
+	double a[10] = { 0.0 };
+
+	void AddPlane(const gp_XYZ& normal, double d, double weight);
+	void Add(const Quadric& q);
+	double Evaluate(const gp_XYZ& p) const;
+};
+
+// Quadric error edge collapse of a face mesh; boundary, edge polyline and feature nodes never move.
+// Holds the working state of one mesh at a time, so use one decimator per thread.
+class MeshDecimator {
+public:
+	MeshDecimator(void);
+	~MeshDecimator(void);
+
+	// Decimated copy of a mesh keeping about ratio of its triangles, as close as the locked nodes allow
+	Mesh* Decimate(const Mesh* mesh, double ratio, Arena& arena);
+
+protected:
+	void Initialize(const Mesh* mesh);
+	bool CanCollapse(int from, int to, const gp_XYZ& position) const;
+	void Collapse(int from, int to, const gp_XYZ& position);
+	void PushEdges(int v);
+	Mesh* GetMesh(const Mesh* mesh, Arena& arena) const;
+
+private:
+	struct EdgeCost {
+		double cost;
+		int from;
+		int to;
+		int fromStamp;
+		int toStamp;
+		gp_XYZ position;
+
+		bool operator>(const EdgeCost& other) const { return cost > other.cost; }
+	};
+
+	// Working state of the mesh being decimated
+	vector<gp_XYZ> m_positions;
+	vector<Quadric> m_quadrics;
+	vector<bool> m_isLocked;
+	vector<int> m_stamps;
+	vector<array<int, 3>> m_triangles;
+	vector<bool> m_isRemoved;
+	vector<vector<int>> m_vertexTriangles;
+	priority_queue<EdgeCost, vector<EdgeCost>, greater<EdgeCost>> m_heap;
+	int m_triangleCount;
+};
\ No newline at end of file
@@ -0,0 +1,182 @@
+#include "CommonImport.h"
+#include "MeshOptimizer.h"
+#include "Mesh.h"
+
+MeshOptimizer::MeshOptimizer(int cacheSize)
+	: m_cacheSize(cacheSize) {}
+
+MeshOptimizer::~MeshOptimizer(void) {}
+
+void MeshOptimizer::Optimize(Mesh* mesh) const {
+	if (mesh->GetFaceIndexSize() < 2)
+		return;
+
+	mesh->ReorderFaces(Tipsify(mesh));
+	ReorderVertices(mesh);
+}
+
+const int MeshOptimizer::CountCacheMisses(const Mesh* mesh) const {
+	// A vertex is still cached if fewer than m_cacheSize vertices entered the cache after it
+	vector<int> cacheTime(mesh->GetCoordinateSize(), -m_cacheSize);
+	int time = 0;
+	int misses = 0;
+
+	for (int i = 0; i < mesh->GetFaceIndexSize(); ++i) {
+		const Index& faceIndex = mesh->GetFaceIndexAt(i);
+
+		for (int k = 0; k < 3; ++k) {
+			int v = faceIndex[k] - 1;
+
+			if (time - cacheTime[v] >= m_cacheSize) {
+				cacheTime[v] = time;
+				time++;
+				misses++;
+			}
+		}
+	}
+
+	return misses;
+}
+
+vector<int> MeshOptimizer::Tipsify(const Mesh* mesh) const {
+	int vertexCount = mesh->GetCoordinateSize();
+	int triangleCount = mesh->GetFaceIndexSize();
+
+	// Triangles around each vertex, stored contiguously
+	vector<int> live(vertexCount, 0);
+	for (int i = 0; i < triangleCount; ++i) {
+		const Index& faceIndex = mesh->GetFaceIndexAt(i);
+		for (int k = 0; k < 3; ++k)
+			live[faceIndex[k] - 1]++;
+	}
+
+	vector<int> offsets(vertexCount + 1, 0);
+	for (int v = 0; v < vertexCount; ++v)
+		offsets[v + 1] = offsets[v] + live[v];
+
+	vector<int> adjacency(offsets[vertexCount]);
+	vector<int> fill(offsets.begin(), offsets.end() - 1);
+	for (int i = 0; i < triangleCount; ++i) {
+		const Index& faceIndex = mesh->GetFaceIndexAt(i);
+		for (int k = 0; k < 3; ++k)
+			adjacency[fill[faceIndex[k] - 1]++] = i;
+	}
+
+	vector<int> cacheTime(vertexCount, 0);
+	vector<bool> isEmitted(triangleCount, false);
+	vector<int> deadEnd;
+	vector<int> candidates;
+	vector<int> order;
+	order.reserve(triangleCount);
+
+	int timeStamp = m_cacheSize + 1;
+	int cursor = 0;
+	int fanning = mesh->GetFaceIndexAt(0)[0] - 1;
+
+	while (fanning >= 0) {
+		candidates.clear();
+
+		// Emit every remaining triangle around the fanning vertex
+		for (int a = offsets[fanning]; a < offsets[fanning + 1]; ++a) {
+			int t = adjacency[a];
+			if (isEmitted[t])
+				continue;
+
+			const Index& faceIndex = mesh->GetFaceIndexAt(t);
+			for (int k = 0; k < 3; ++k) {
+				int v = faceIndex[k] - 1;
+
+				deadEnd.push_back(v);
+				candidates.push_back(v);
+				live[v]--;
+
+				if (timeStamp - cacheTime[v] > m_cacheSize)
+					cacheTime[v] = timeStamp++;
+			}
+
+			isEmitted[t] = true;
+			order.push_back(t);
+		}
+
+		// Next fanning vertex: the oldest candidate still in the cache after its remaining triangles
+		int best = -1;
+		int bestPriority = numeric_limits<int>::min();
+		for (int v : candidates) {
+			if (live[v] <= 0)
+				continue;
+
+			int priority = 0;
+			if (timeStamp - cacheTime[v] + 2 * live[v] <= m_cacheSize)
+				priority = timeStamp - cacheTime[v];
+
+			// Any live candidate beats the dead-end stack, whatever its priority
+			if (best == -1
+				|| priority > bestPriority) {
+				best = v;
+				bestPriority = priority;
+			}
+		}
+
+		// Dead end, go back to a recent vertex or scan for any vertex left
+		while (best == -1
+			   && !deadEnd.empty()) {
+			int v = deadEnd.back();
+			deadEnd.pop_back();
+
+			if (live[v] > 0)
+				best = v;
+		}
+
+		while (best == -1
+			   && cursor < vertexCount) {
+			if (live[cursor] > 0)
+				best = cursor;
+
+			cursor++;
+		}
+
+		fanning = best;
+	}
+
+	return order;
+}
+
+void MeshOptimizer::ReorderVertices(Mesh* mesh) const {
+	// Number the coordinates and normals in order of first use by the triangles
+	vector<int> newCoordIndex(mesh->GetCoordinateSize(), -1);
+	vector<int> newNormalIndex(mesh->GetNormalSize(), -1);
+	int coordCount = 0;
+	int normalCount = 0;
+
+	for (int i = 0; i < mesh->GetFaceIndexSize(); ++i) {
+		const Index& faceIndex = mesh->GetFaceIndexAt(i);
+
+		for (int k = 0; k < 3; ++k) {
+			if (newCoordIndex[faceIndex[k] - 1] == -1)
+				newCoordIndex[faceIndex[k] - 1] = coordCount++;
+		}
+	}
+
+	for (int i = 0; i < mesh->GetNormalIndexSize(); ++i) {
+		const Index& normalIndex = mesh->GetNormalIndexAt(i);
+
+		for (int k = 0; k < 3; ++k) {
+			if (newNormalIndex[normalIndex[k] - 1] == -1)
+				newNormalIndex[normalIndex[k] - 1] = normalCount++;
+		}
+	}
+
+	// Nodes only used by boundary edges go last
+	for (auto& index : newCoordIndex) {
+		if (index == -1)
+			index = coordCount++;
+	}
+
+	for (auto& index : newNormalIndex) {
+		if (index == -1)
+			index = normalCount++;
+	}
+
+	mesh->RemapCoordinates(newCoordIndex);
+	mesh->RemapNormals(newNormalIndex);
+}
\ No newline at end of file
@@ -0,0 +1,23 @@
+#pragma once
+
+class Mesh;
+
+// Triangle and vertex order for a FIFO post-transform vertex cache (Tipsify, Sander et al. 2007)
+class MeshOptimizer {
+public:
+	MeshOptimizer(int cacheSize);
+	~MeshOptimizer(void);
+
+	// Reorder the triangles of a face mesh, then its coordinates and normals in order of first use
+	void Optimize(Mesh* mesh) const;
+
+	// Vertices transformed again when the mesh is drawn in its current order
+	const int CountCacheMisses(const Mesh* mesh) const;
+
+protected:
+	vector<int> Tipsify(const Mesh* mesh) const;
+	void ReorderVertices(Mesh* mesh) const;
+
+private:
+	int m_cacheSize;
+};
\ No newline at end of file
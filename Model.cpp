@@ -3,12 +3,28 @@
 #include "Component.h"
 #include "IShape.h"
 
-Model::Model(void) {}
+Model::Model(void)
+	: m_rootComponents(&m_arena),
+	m_isGlobalIndexDirty(false) {}
 
 Model::~Model(void) {
 	Clear();
 }
 
+Component* Model::NewComponent(const TopoDS_Shape& shape) {
+	return m_arena.New<Component>(shape, &m_arena);
+}
+
+IShape* Model::NewIShape(const TopoDS_Shape& shape) {
+	return m_arena.New<IShape>(shape, &m_arena);
+}
+
+void Model::AddComponent(Component*& comp) {
+	m_rootComponents.push_back(comp);
+	m_nameRegistry.Add(comp);
+	m_isGlobalIndexDirty = true;
+}
+
 void Model::GetAllComponents(vector<Component*>& comps) const {
 	for (const auto& rootComp : m_rootComponents) {
 		comps.push_back(rootComp);
@@ -26,6 +42,51 @@ const Bnd_Box Model::GetBoundingBox(bool sketch) const {
 	return bndBox;
 }
 
+void Model::ComputeBoundingBoxes(bool fromMesh) const {
+	vector<Component*> comps;
+	GetAllComponents(comps);
+
+	vector<IShape*> iShapes;
+	for (const auto& comp : comps) {
+		for (int i = 0; i < comp->GetIShapeSize(); ++i)
+			iShapes.push_back(comp->GetIShapeAt(i));
+	}
+
+	OSD_Parallel::For(0, (int)iShapes.size(), [&iShapes, fromMesh](int i) {
+		iShapes[i]->ComputeBoundingBox(fromMesh);
+	});
+
+	// Component boxes are unions of the new IShape boxes
+	for (const auto& comp : comps)
+		comp->InvalidateBoundingBox();
+
+	comps.clear();
+}
+
+void Model::ComputeOrientedBoundingBoxes(void) const {
+	vector<Component*> comps;
+	GetAllComponents(comps);
+
+	vector<IShape*> iShapes;
+	for (const auto& comp : comps) {
+		for (int i = 0; i < comp->GetIShapeSize(); ++i) {
+			IShape* iShape = comp->GetIShapeAt(i);
+
+			if (iShape->IsFaceSet())
+				iShapes.push_back(iShape);
+		}
+	}
+
+	OSD_Parallel::For(0, (int)iShapes.size(), [&iShapes](int i) {
+		iShapes[i]->ComputeOrientedBoundingBox();
+	});
+
+	for (const auto& comp : comps)
+		comp->ComputeOrientedBoundingBox();
+
+	comps.clear();
+}
+
 const ShapeType Model::GetShapeType(void) const {
 	vector<Component*> comps;
 	GetAllComponents(comps);
@@ -71,7 +132,10 @@ bool Model::IsEmpty(void) const {
 
 void Model::Update(void) {
 	Clean();
-	UpdateNames();
+
+	// Names are kept up to date by the registry, only the indexes may be stale
+	if (m_isGlobalIndexDirty)
+		UpdateGlobalIShapeIndex();
 }
 
 void Model::Clean(void) {
@@ -80,119 +144,21 @@ void Model::Clean(void) {
 		Component* rootComp = GetComponentAt(i);
 		if (rootComp->IsEmpty()) {
 			m_rootComponents.erase(m_rootComponents.begin() + i);
-			delete rootComp;
-		} else
-			rootComp->Clean();
-	}
-}
-
-void Model::UpdateNames(void) const {
-	UpdateComponentNames();
-	UpdateIShapeNames();
-	UpdateGlobalIShapeIndex();
-}
-
-
-void Model::UpdateComponentNames(void) const {
-	wstring connector = L"_";	// Character connecting Group name and order
-
-	// Make all components' names unique to avoid conflict
-	vector<Component*> comps;
-	GetAllComponents(comps);
-
-	map<wstring, int> tmpNameCountMap, nameCountMap;
-
-	// Count all component names first
-	for (const auto& comp : comps) {
-		wstring compName = comp->GetName();
-
-		// Skip if the name is empty
-		if (compName.empty())
-			continue;
-
-		if (tmpNameCountMap.find(compName) == tmpNameCountMap.end())
-			tmpNameCountMap.insert({ compName, 1 });
-		else {
-			int count = tmpNameCountMap[compName];
-			count++;
-			tmpNameCountMap[compName] = count;
-		}
-	}
-
-	// Update all component names
-	for (const auto& comp : comps) {
-		wstring compName = comp->GetName();
-
-		// Skip if the name is empty
-		if (compName.empty())
-			continue;
-
-		// Skip if the name is one and only
-		if (tmpNameCountMap.find(compName)->second == 1)
-			continue;
-
-		if (nameCountMap.find(compName) == nameCountMap.end()) {
-			nameCountMap.insert({ compName, 1 });
-			comp->SetName(compName + connector + to_wstring(1));
-		} else {
-			int count = nameCountMap[compName];
-			count++;
-			nameCountMap[compName] = count;
-			comp->SetName(compName + connector + to_wstring(count));
-		}
-	}
-
-	tmpNameCountMap.clear();
-	nameCountMap.clear();
-
-	// Update subcomponent names
-	for (const auto& comp : comps) {
-		if (comp->IsRoot()
-			&& !comp->HasUniqueName())
-			comp->SetName(L"unnamed");
-
-		wstring compName = comp->GetName();
-		int compIndex = 1;
-	}
-
-	comps.clear();
-}
-
-void Model::UpdateIShapeNames(void) const {
-	wstring connector = L"_";	// Character connecting IShape name and order
-
-	vector<Component*> comps;
-	GetAllComponents(comps);
-
-	for (const auto& comp : comps) {
-		wstring compName = comp->GetName();
-		int shapeIndex = 1;
-
-		for (int i = 0; i < comp->GetIShapeSize(); ++i) {
-			IShape* iShape = comp->GetIShapeAt(i);
-
-			if (iShape->IsSketchGeometry())
-				continue;
-
-			iShape->SetName(compName + connector + to_wstring(shapeIndex));
-			shapeIndex++;
-		}
+			m_nameRegistry.Remove(rootComp);
+			Arena::Delete(rootComp);
+			m_isGlobalIndexDirty = true;
+		} else if (rootComp->Clean())
+			m_isGlobalIndexDirty = true;
 	}
-
-	comps.clear();
 }
 
-void Model::UpdateGlobalIShapeIndex(void) const {
-	vector<Component*> comps;
-	GetAllComponents(comps);
-
+void Model::UpdateGlobalIShapeIndex(void) {
 	// Global shape index for Coordinate DEF/USE
 	int globalIndex = 1;
 
-	// Update names and indexes of iShapes at every update
-	for (const auto& comp : comps) {
-		for (int i = 0; i < comp->GetIShapeSize(); ++i) {
-			IShape* iShape = comp->GetIShapeAt(i);
+	for (const auto& rootComp : m_rootComponents) {
+		for (int i = 0; i < rootComp->GetIShapeSize(); ++i) {
+			IShape* iShape = rootComp->GetIShapeAt(i);
 
 			if (iShape->IsSketchGeometry())
 				continue;
@@ -202,11 +168,16 @@ void Model::UpdateGlobalIShapeIndex(void) const {
 		}
 	}
 
-	comps.clear();
+	m_isGlobalIndexDirty = false;
 }
 
 void Model::Clear(void) {
+	// Destructors only release OCCT handles, the memory goes back with the arena
 	for (auto rootComp : m_rootComponents)
-		delete rootComp;
-	m_rootComponents.clear();
+		Arena::Delete(rootComp);
+
+	pmr::vector<Component*>(&m_arena).swap(m_rootComponents);
+	m_nameRegistry.Clear();
+	m_isGlobalIndexDirty = false;
+	m_arena.Release();
 }
\ No newline at end of file
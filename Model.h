@@ -1,6 +1,17 @@
 #pragma once
 
 class Component;
+class IShape;
+
+// Part of the root shape handled by a sharded run
+struct ShardInfo {
+	int index = 0;
+	int count = 1;
+	int solidBegin = 0;		// First solid of the shard
+	int solidEnd = 0;		// One past the last solid of the shard
+	int solidSize = 0;		// Solids in the whole root shape
+	double deflection = 0.0;	// Linear deflection of the whole root shape, shared by all shards
+};
 
 class Model {
 
@@ -8,14 +19,25 @@ public:
 	Model(void);
 	~Model(void);
 
-	void AddComponent(Component*& comp) { m_rootComponents.push_back(comp); }
+	// Components, IShapes and Meshes of a model must be created in its arena
+	Component* NewComponent(const TopoDS_Shape& shape);
+	IShape* NewIShape(const TopoDS_Shape& shape);
+	Arena& GetArena(void) { return m_arena; }
+
+	// Names and IShapes of a component must be set before it is added
+	void AddComponent(Component*& comp);
 	Component* GetComponentAt(int index) const { return m_rootComponents[index]; }
 	const int GetComponentSize(void) const { return (int)m_rootComponents.size(); }
 
 	void GetAllComponents(vector<Component*>& comps) const;
 	const Bnd_Box GetBoundingBox(bool sketch) const;
+	void ComputeBoundingBoxes(bool fromMesh) const;
+	void ComputeOrientedBoundingBoxes(void) const;
 	const ShapeType GetShapeType(void) const;
 
+	void SetShardInfo(const ShardInfo& shardInfo) { m_shardInfo = shardInfo; }
+	const ShardInfo& GetShardInfo(void) const { return m_shardInfo; }
+
 	bool IsEmpty(void) const;
 
 	void Update(void);
@@ -24,11 +46,12 @@ public:
 protected:
 	void Clean(void);
 
-	void UpdateNames(void) const;
-	void UpdateComponentNames(void) const;
-	void UpdateIShapeNames(void) const;
-	void UpdateGlobalIShapeIndex(void) const;
+	void UpdateGlobalIShapeIndex(void);
 
 private:
-	vector<Component*> m_rootComponents;
+	Arena m_arena;	// Owns every object of the model, declared first to be released last
+	pmr::vector<Component*> m_rootComponents;
+	NameRegistry m_nameRegistry;
+	bool m_isGlobalIndexDirty;	// Components or IShapes were added or removed since the last indexing
+	ShardInfo m_shardInfo;
 };
\ No newline at end of file
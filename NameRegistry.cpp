@@ -0,0 +1,81 @@
+#include "CommonImport.h"
+#include "NameRegistry.h"
+#include "Component.h"
+
+NameRegistry::NameRegistry(void) {}
+
+NameRegistry::~NameRegistry(void) {
+	Clear();
+}
+
+const wstring NameRegistry::GetBaseName(Component* comp) const {
+	// A root without a unique name is shown as unnamed
+	if (comp->IsRoot()
+		&& !comp->HasUniqueName())
+		return L"unnamed";
+
+	return comp->GetName();
+}
+
+void NameRegistry::Add(Component* comp) {
+	wstring name = GetBaseName(comp);
+
+	// Skip if the name is empty
+	if (name.empty())
+		return;
+
+	auto it = m_nameIndexMap.try_emplace(name, (int)m_names.size()).first;
+	int nameIndex = it->second;
+
+	if (nameIndex == (int)m_names.size()) {
+		m_names.push_back(name);
+		m_holders.emplace_back();
+	}
+
+	vector<Component*>& holders = m_holders[nameIndex];
+	holders.push_back(comp);
+	m_compNameIndexMap[comp] = nameIndex;
+
+	// Only the new holder is numbered, and the first one once the name stops being unique
+	Rename(nameIndex, holders.size() == 2 ? 0 : holders.size() - 1);
+}
+
+void NameRegistry::Remove(Component* comp) {
+	auto it = m_compNameIndexMap.find(comp);
+	if (it == m_compNameIndexMap.end())
+		return;
+
+	int nameIndex = it->second;
+	m_compNameIndexMap.erase(it);
+
+	vector<Component*>& holders = m_holders[nameIndex];
+	auto holderIt = find(holders.begin(), holders.end(), comp);
+	size_t position = holderIt - holders.begin();
+	holders.erase(holderIt);
+
+	// The holders after the removed one move up by one, a last holder gets the plain name back
+	Rename(nameIndex, holders.size() == 1 ? 0 : position);
+}
+
+void NameRegistry::Rename(int nameIndex, size_t begin) const {
+	wstring connector = L"_";	// Character connecting Group name and order
+
+	const wstring& name = m_names[nameIndex];
+	const vector<Component*>& holders = m_holders[nameIndex];
+
+	// Keep the name if it is one and only
+	if (holders.size() == 1) {
+		holders[0]->SetName(name);
+		return;
+	}
+
+	for (size_t i = begin; i < holders.size(); ++i)
+		holders[i]->SetName(name + connector + to_wstring(i + 1));
+}
+
+void NameRegistry::Clear(void) {
+	m_nameIndexMap.clear();
+	m_names.clear();
+	m_holders.clear();
+	m_compNameIndexMap.clear();
+}
\ No newline at end of file
@@ -0,0 +1,29 @@
+#pragma once
+
+class Component;
+
+// Unique component names maintained incrementally as components are added and removed.
+// Names are interned once; components sharing a base name are numbered name_1, name_2..
+// in the order they were added.
+class NameRegistry {
+public:
+	NameRegistry(void);
+	~NameRegistry(void);
+
+	// Register a component under its current name and rename the components sharing it
+	void Add(Component* comp);
+	void Remove(Component* comp);
+
+	void Clear(void);
+
+protected:
+	const wstring GetBaseName(Component* comp) const;
+	// Set the names of the holders from position begin on, the others keep theirs
+	void Rename(int nameIndex, size_t begin) const;
+
+private:
+	unordered_map<wstring, int> m_nameIndexMap;				// Interned base names
+	vector<wstring> m_names;
+	vector<vector<Component*>> m_holders;					// Components per interned name
+	unordered_map<const Component*, int> m_compNameIndexMap;
+};
\ No newline at end of file
@@ -1,12 +1,17 @@
 #pragma once
 
 // OpenCascade includes
+#include <Standard_Version.hxx>
 #include <BinXCAFDrivers.hxx>
 #include <TDocStd_Application.hxx>
 
 #include <Poly.hxx>
 #include <Poly_Triangulation.hxx>
 #include <BRepMesh_IncrementalMesh.hxx>
+#include <IMeshTools_Parameters.hxx>
+#include <Message_ProgressIndicator.hxx>
+#include <Message_ProgressRange.hxx>
+#include <Message_ProgressScope.hxx>
 
 #include <STEPControl_Reader.hxx>
 #include <STEPCAFControl_Reader.hxx>
@@ -42,7 +47,11 @@
 #include <BRepBuilderAPI_Copy.hxx>
 #include <BRepTools.hxx>
 #include <BRepBndLib.hxx>
+#include <Bnd_OBB.hxx>
 #include <BRepGProp_Face.hxx>
+#include <BRepAdaptor_Surface.hxx>
+#include <Geom_BSplineSurface.hxx>
+#include <Geom_BezierSurface.hxx>
 #include <BRepBuilderAPI_MakeEdge.hxx>
 
 #include <TopoDS.hxx>
@@ -51,6 +60,8 @@
 
 #include <TopExp.hxx>
 #include <TopExp_Explorer.hxx>
+#include <TopTools_DataMapOfShapeInteger.hxx>
+#include <TopTools_IndexedMapOfShape.hxx>
 
 #include <TopOpeBRepBuild_Tools.hxx>
 
@@ -73,4 +84,6 @@
 #include <Prs3d.hxx>
 #include <Prs3d_Drawer.hxx>
 
-#include <OSD.hxx>
\ No newline at end of file
+#include <OSD.hxx>
+#include <OSD_MemInfo.hxx>
+#include <OSD_Parallel.hxx>
\ No newline at end of file
@@ -10,7 +10,32 @@ namespace OCCUtil {
 
 	const Bnd_Box ComputeBoundingBox(const TopoDS_Shape& shape) {
 		Bnd_Box bndBox;
-		BRepBndLib::Add(shape, bndBox);
+		if (shape.IsNull())
+			return bndBox;
+
+		// Split compounds so that their sub-shapes are bounded in parallel
+		vector<TopoDS_Shape> subShapes;
+		vector<TopoDS_Shape> compounds = { shape };
+		while (!compounds.empty()) {
+			TopoDS_Shape compound = compounds.back();
+			compounds.pop_back();
+
+			if (compound.ShapeType() != TopAbs_COMPOUND) {
+				subShapes.push_back(compound);
+				continue;
+			}
+
+			for (TopoDS_Iterator it(compound); it.More(); it.Next())
+				compounds.push_back(it.Value());
+		}
+
+		vector<Bnd_Box> subBndBoxes(subShapes.size());
+		OSD_Parallel::For(0, (int)subShapes.size(), [&subShapes, &subBndBoxes](int i) {
+			BRepBndLib::Add(subShapes[i], subBndBoxes[i]);
+		});
+
+		for (const auto& subBndBox : subBndBoxes)
+			bndBox.Add(subBndBox);
 
 		return bndBox;
 	}
@@ -77,6 +102,72 @@ namespace OCCUtil {
 		return bMesh.IsDone();
 	}
 
+	bool TessellateShape(const TopoDS_Shape& shape, const IMeshTools_Parameters& parameters, const Message_ProgressRange& range) {
+		BRepTools::Clean(shape);
+		BRepMesh_IncrementalMesh bMesh(shape, parameters, range);
+
+		return bMesh.IsDone();
+	}
+
+	int CountTriangles(const TopoDS_Shape& shape) {
+		int triangleCount = 0;
+
+		// Located instances of a face share its triangulation
+		unordered_set<const TopoDS_TShape*> visited;
+		TopExp_Explorer ExpFace;
+		for (ExpFace.Init(shape, TopAbs_FACE); ExpFace.More(); ExpFace.Next()) {
+			if (!visited.insert(ExpFace.Current().TShape().get()).second)
+				continue;
+
+			TopLoc_Location loc;
+			Handle(Poly_Triangulation) triangulation = BRep_Tool::Triangulation(TopoDS::Face(ExpFace.Current()), loc);
+
+			if (!triangulation.IsNull())
+				triangleCount += triangulation->NbTriangles();
+		}
+
+		return triangleCount;
+	}
+
+	void TransformNodes(const Poly_ArrayOfNodes& nodes, const TopLoc_Location& loc, gp_XYZ* coords) {
+		int nodeCount = nodes.Length();
+		if (nodeCount == 0)
+			return;
+
+		// Double precision nodes are read in place, single precision ones converted
+		if (nodes.IsDoublePrecision()) {
+			const gp_Pnt* pnts = &nodes.Value<gp_Pnt>(0);
+			for (int i = 0; i < nodeCount; ++i)
+				coords[i] = pnts[i].XYZ();
+		} else {
+			for (int i = 0; i < nodeCount; ++i) {
+				const gp_Vec3f& node = nodes.Value<gp_Vec3f>(i);
+				coords[i].SetCoord(node.x(), node.y(), node.z());
+			}
+		}
+
+		if (loc.IsIdentity())
+			return;
+
+		// Rows of the 3x4 matrix, scale included, applied with plain arithmetic the compiler can vectorize
+		const gp_Trsf& trsf = loc.Transformation();
+		double m[12];
+		for (int row = 0; row < 3; ++row) {
+			for (int col = 0; col < 4; ++col)
+				m[4 * row + col] = trsf.Value(row + 1, col + 1);
+		}
+
+		for (int i = 0; i < nodeCount; ++i) {
+			double x = coords[i].X();
+			double y = coords[i].Y();
+			double z = coords[i].Z();
+
+			coords[i].SetCoord(m[0] * x + m[1] * y + m[2] * z + m[3],
+							   m[4] * x + m[5] * y + m[6] * z + m[7],
+							   m[8] * x + m[9] * y + m[10] * z + m[11]);
+		}
+	}
+
 	bool IsTranslated(const gp_Trsf& transform) {
 		const gp_XYZ& trans = transform.TranslationPart();
 
@@ -108,9 +199,14 @@ namespace OCCUtil {
 	}
 
 	double GetDeflection(const TopoDS_Shape& shape) {
-		Bnd_Box bndBox = ComputeBoundingBox(shape);
+		return GetDeflection(ComputeBoundingBox(shape));
+	}
+
+	double GetDeflection(const Bnd_Box& shapeBndBox) {
+		Bnd_Box bndBox = shapeBndBox.FinitePart();
 
-		bndBox = bndBox.FinitePart();
+		if (bndBox.IsVoid())
+			return Precision::Confusion();
 
 		gp_Pnt minPnt = bndBox.CornerMin();
 		gp_Pnt maxPnt = bndBox.CornerMax();
@@ -4,7 +4,7 @@ namespace OCCUtil {
 	// Get unique id for shape
 	const int GetID(const TopoDS_Shape& shape);
 
-	// Compute bounding box of a shape
+	// Compute bounding box of a shape, sub-shapes of compounds in parallel
 	const Bnd_Box ComputeBoundingBox(const TopoDS_Shape& shape);
 
 	// Compute volue of a shape
@@ -27,6 +27,13 @@ namespace OCCUtil {
 
 	// Tessellate a shape
 	bool TessellateShape(const TopoDS_Shape& shape, double linearDeflection, bool isRelative, double angularDeflection, bool isParallel);
+	bool TessellateShape(const TopoDS_Shape& shape, const IMeshTools_Parameters& parameters, const Message_ProgressRange& range = Message_ProgressRange());
+
+	// Count the triangles of the face triangulations of a shape, once per shared face
+	int CountTriangles(const TopoDS_Shape& shape);
+
+	// Copy the nodes of a triangulation into coords, moved by the location unless it is the identity
+	void TransformNodes(const Poly_ArrayOfNodes& nodes, const TopLoc_Location& loc, gp_XYZ* coords);
 
 	// Check if translated
 	bool IsTranslated(const gp_Trsf& transform);
@@ -39,4 +46,7 @@ namespace OCCUtil {
 
 	// Get the relative deflection for a given shape
 	double GetDeflection(const TopoDS_Shape& shape);
+
+	// Get the relative deflection for a given bounding box
+	double GetDeflection(const Bnd_Box& shapeBndBox);
 }
\ No newline at end of file
@@ -0,0 +1,58 @@
+#include "CommonImport.h"
+#include "ProgressIndicator.h"
+#include <iomanip>
+
+ProgressIndicator::ProgressIndicator(bool isPrinted)
+	: m_isCancelled(false),
+	m_isPrinted(isPrinted),
+	m_lastPercent(-1) {}
+
+ProgressIndicator::~ProgressIndicator(void) {}
+
+void ProgressIndicator::Show(const Message_ProgressScope& scope, const Standard_Boolean isForce) {
+	double fraction = Min(Max(GetPosition(), 0.0), 1.0);
+	int percent = (int)(fraction * 100.0);
+	string stage = GetStageName(scope);
+
+	if (!isForce
+		&& percent == m_lastPercent
+		&& stage == m_lastStage)
+		return;
+
+	if (m_callback) {
+		m_callback(stage, fraction);
+	} else if (m_isPrinted
+			   && (stage != m_lastStage || percent / 10 != m_lastPercent / 10)) {
+		cout << "\t[" << setw(3) << percent << "%] " << stage << endl;
+	}
+
+	m_lastPercent = percent;
+	m_lastStage = stage;
+}
+
+void ProgressIndicator::Reset(void) {
+	Message_ProgressIndicator::Reset();
+
+	m_lastPercent = -1;
+	m_lastStage.clear();
+}
+
+const string ProgressIndicator::GetStageName(const Message_ProgressScope& scope) {
+	// Names from the innermost scope up to the root, unnamed OCCT scopes are skipped
+	vector<string> names;
+	for (const Message_ProgressScope* s = &scope; s != nullptr; s = s->Parent()) {
+		if (s->Name() != nullptr
+			&& s->Parent() != nullptr)
+			names.push_back(s->Name());
+	}
+
+	if (names.empty())
+		return "";
+
+	// The stage, followed by its current step if it has a named one
+	string stage = names.back();
+	if (names.size() > 1)
+		stage += " / " + names[names.size() - 2];
+
+	return stage;
+}
\ No newline at end of file
@@ -0,0 +1,33 @@
+#pragma once
+
+// Progress of a translation across its stages; Cancel stops the OCCT algorithms and the pipeline at their next check.
+// Stages are the scopes opened right below the root scope, e.g. "Reading STEP" or "Tessellating".
+class ProgressIndicator : public Message_ProgressIndicator {
+public:
+	typedef function<void(const string& stage, double fraction)> Callback;
+
+	ProgressIndicator(bool isPrinted = false);
+	~ProgressIndicator(void);
+
+	// Called with the stage and the fraction of the whole translation, at most once per percent
+	void SetCallback(const Callback& callback) { m_callback = callback; }
+
+	// Cancel token, safe to set from another thread or a signal handler
+	void Cancel(void) { m_isCancelled = true; }
+	bool IsCancelled(void) const { return m_isCancelled; }
+
+	Standard_Boolean UserBreak(void) override { return m_isCancelled; }
+	void Show(const Message_ProgressScope& scope, const Standard_Boolean isForce) override;
+	void Reset(void) override;
+
+	static const string GetStageName(const Message_ProgressScope& scope);
+
+private:
+	atomic<bool> m_isCancelled;
+	bool m_isPrinted;		// Print a line per ten percent when no callback is set
+	Callback m_callback;
+
+	// Show is serialized by Message_ProgressIndicator, no lock needed
+	int m_lastPercent;
+	string m_lastStage;
+};
\ No newline at end of file
@@ -0,0 +1,182 @@
+#include "CommonImport.h"
+#include "ShapeFingerprint.h"
+#include <iomanip>
+
+// FNV-1a over 64 bits
+constexpr uint64_t FNV_OFFSET_BASIS = 14695981039346656037ULL;
+constexpr uint64_t FNV_PRIME = 1099511628211ULL;
+
+// Quantization steps of lengths and of unitless values such as parameters and direction components
+constexpr double LENGTH_STEP = 1.0e-6;
+constexpr double REAL_STEP = 1.0e-9;
+
+// Surface samples per parameter direction
+constexpr int SAMPLE_SIZE = 3;
+
+ShapeFingerprint::ShapeFingerprint(void)
+	: m_hash(FNV_OFFSET_BASIS) {}
+
+ShapeFingerprint::~ShapeFingerprint(void) {}
+
+uint64_t ShapeFingerprint::Compute(const TopoDS_Shape& shape) {
+	ShapeFingerprint fingerprint;
+
+	int faceCount = 0;
+	TopExp_Explorer ExpFace;
+	for (ExpFace.Init(shape, TopAbs_FACE); ExpFace.More(); ExpFace.Next()) {
+		fingerprint.AddFace(TopoDS::Face(ExpFace.Current()));
+		faceCount++;
+	}
+
+	fingerprint.AddInt(faceCount);
+
+	return fingerprint.GetValue();
+}
+
+const string ShapeFingerprint::ToString(uint64_t fingerprint) {
+	stringstream ss;
+	ss << hex << setw(16) << setfill('0') << fingerprint;
+
+	return ss.str();
+}
+
+void ShapeFingerprint::AddFace(const TopoDS_Face& face) {
+	AddInt(face.Orientation());
+
+	// The adaptor applies the face location, so the placement is part of the hash
+	BRepAdaptor_Surface surface(face, true);
+	GeomAbs_SurfaceType surfaceType = surface.GetType();
+	AddInt(surfaceType);
+
+	switch (surfaceType) {
+	case GeomAbs_Plane:
+		AddPosition(surface.Plane().Position());
+		break;
+	case GeomAbs_Cylinder:
+		AddPosition(surface.Cylinder().Position());
+		AddLength(surface.Cylinder().Radius());
+		break;
+	case GeomAbs_Cone:
+		AddPosition(surface.Cone().Position());
+		AddLength(surface.Cone().RefRadius());
+		AddReal(surface.Cone().SemiAngle());
+		break;
+	case GeomAbs_Sphere:
+		AddPosition(surface.Sphere().Position());
+		AddLength(surface.Sphere().Radius());
+		break;
+	case GeomAbs_Torus:
+		AddPosition(surface.Torus().Position());
+		AddLength(surface.Torus().MajorRadius());
+		AddLength(surface.Torus().MinorRadius());
+		break;
+	case GeomAbs_BezierSurface:
+	case GeomAbs_BSplineSurface: {
+		AddInt(surface.UDegree());
+		AddInt(surface.VDegree());
+		AddInt(surface.NbUPoles());
+		AddInt(surface.NbVPoles());
+
+		if (surfaceType == GeomAbs_BezierSurface) {
+			const Handle(Geom_BezierSurface)& bezier = surface.Bezier();
+			for (int i = 1; i <= bezier->NbUPoles(); ++i) {
+				for (int j = 1; j <= bezier->NbVPoles(); ++j) {
+					AddPoint(bezier->Pole(i, j));
+					AddReal(bezier->Weight(i, j));
+				}
+			}
+			break;
+		}
+
+		const Handle(Geom_BSplineSurface)& bSpline = surface.BSpline();
+		for (int i = 1; i <= bSpline->NbUPoles(); ++i) {
+			for (int j = 1; j <= bSpline->NbVPoles(); ++j) {
+				AddPoint(bSpline->Pole(i, j));
+				AddReal(bSpline->Weight(i, j));
+			}
+		}
+
+		for (int i = 1; i <= bSpline->NbUKnots(); ++i) {
+			AddReal(bSpline->UKnot(i));
+			AddInt(bSpline->UMultiplicity(i));
+		}
+
+		for (int i = 1; i <= bSpline->NbVKnots(); ++i) {
+			AddReal(bSpline->VKnot(i));
+			AddInt(bSpline->VMultiplicity(i));
+		}
+		break;
+	}
+	default:
+		// Other surfaces are covered by the samples below
+		break;
+	}
+
+	// Trimmed domain and a grid of samples over it
+	double uMin = 0.0, uMax = 0.0, vMin = 0.0, vMax = 0.0;
+	BRepTools::UVBounds(face, uMin, uMax, vMin, vMax);
+	AddReal(uMin);
+	AddReal(uMax);
+	AddReal(vMin);
+	AddReal(vMax);
+
+	for (int i = 0; i < SAMPLE_SIZE; ++i) {
+		for (int j = 0; j < SAMPLE_SIZE; ++j) {
+			double u = uMin + (uMax - uMin) * i / (SAMPLE_SIZE - 1);
+			double v = vMin + (vMax - vMin) * j / (SAMPLE_SIZE - 1);
+			AddPoint(surface.Value(u, v));
+		}
+	}
+
+	// Boundaries, in the order of the wires
+	int edgeCount = 0;
+	TopExp_Explorer ExpEdge;
+	for (ExpEdge.Init(face, TopAbs_EDGE); ExpEdge.More(); ExpEdge.Next()) {
+		const TopoDS_Edge& edge = TopoDS::Edge(ExpEdge.Current());
+		TopoDS_Vertex firstVertex, lastVertex;
+		TopExp::Vertices(edge, firstVertex, lastVertex);
+
+		if (!firstVertex.IsNull())
+			AddPoint(BRep_Tool::Pnt(firstVertex));
+
+		if (!lastVertex.IsNull())
+			AddPoint(BRep_Tool::Pnt(lastVertex));
+
+		edgeCount++;
+	}
+
+	AddInt(edgeCount);
+}
+
+void ShapeFingerprint::AddInt(long long value) {
+	for (int i = 0; i < 8; ++i) {
+		m_hash ^= (uint64_t)((value >> (8 * i)) & 0xff);
+		m_hash *= FNV_PRIME;
+	}
+}
+
+void ShapeFingerprint::AddLength(double value) {
+	AddInt(llround(value / LENGTH_STEP));
+}
+
+void ShapeFingerprint::AddReal(double value) {
+	AddInt(llround(value / REAL_STEP));
+}
+
+void ShapeFingerprint::AddPoint(const gp_Pnt& point) {
+	AddLength(point.X());
+	AddLength(point.Y());
+	AddLength(point.Z());
+}
+
+void ShapeFingerprint::AddDirection(const gp_Dir& direction) {
+	AddReal(direction.X());
+	AddReal(direction.Y());
+	AddReal(direction.Z());
+}
+
+void ShapeFingerprint::AddPosition(const gp_Ax3& position) {
+	AddPoint(position.Location());
+	AddDirection(position.Direction());
+	AddDirection(position.XDirection());
+}
\ No newline at end of file
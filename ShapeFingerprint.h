@@ -0,0 +1,27 @@
+#pragma once
+
+// Canonical 64-bit hash of the geometry of a shape: for each face in order, its orientation, surface type,
+// surface parameters, UV bounds, a few surface samples and the vertices of its edges.
+// Values are quantized so that the noise of a re-export does not change the fingerprint.
+class ShapeFingerprint {
+public:
+	ShapeFingerprint(void);
+	~ShapeFingerprint(void);
+
+	static uint64_t Compute(const TopoDS_Shape& shape);
+	static const string ToString(uint64_t fingerprint);
+
+	void AddFace(const TopoDS_Face& face);
+
+	void AddInt(long long value);
+	void AddLength(double value);
+	void AddReal(double value);
+	void AddPoint(const gp_Pnt& point);
+	void AddDirection(const gp_Dir& direction);
+	void AddPosition(const gp_Ax3& position);
+
+	uint64_t GetValue(void) const { return m_hash; }
+
+private:
+	uint64_t m_hash;
+};
\ No newline at end of file
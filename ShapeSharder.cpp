@@ -0,0 +1,65 @@
+#include "CommonImport.h"
+#include "ShapeSharder.h"
+
+ShapeSharder::ShapeSharder(const TopoDS_Shape& shape, int shardCount)
+	: m_shardCount(max(1, shardCount)) {
+	// Solids in explorer order with their face counts
+	TopExp_Explorer ExpSolid;
+	for (ExpSolid.Init(shape, TopAbs_SOLID); ExpSolid.More(); ExpSolid.Next()) {
+		const TopoDS_Shape& solid = ExpSolid.Current();
+		int faceCount = 0;
+
+		TopExp_Explorer ExpFace;
+		for (ExpFace.Init(solid, TopAbs_FACE); ExpFace.More(); ExpFace.Next())
+			faceCount++;
+
+		m_solids.push_back(solid);
+		m_faceCounts.push_back(faceCount);
+	}
+
+	// Faces which do not belong to a solid
+	TopExp_Explorer ExpFace;
+	for (ExpFace.Init(shape, TopAbs_FACE, TopAbs_SOLID); ExpFace.More(); ExpFace.Next())
+		m_freeFaces.push_back(ExpFace.Current());
+
+	ComputeBounds();
+}
+
+ShapeSharder::~ShapeSharder(void) {}
+
+void ShapeSharder::ComputeBounds(void) {
+	int solidSize = GetSolidSize();
+	long long totalFaceCount = accumulate(m_faceCounts.begin(), m_faceCounts.end(), 0LL);
+	long long faceCount = 0;
+
+	m_bounds.assign(m_shardCount + 1, solidSize);
+	m_bounds[0] = 0;
+
+	// Close shard k once it holds k/N of all faces
+	int shardIndex = 1;
+	for (int i = 0; i < solidSize && shardIndex < m_shardCount; ++i) {
+		faceCount += m_faceCounts[i];
+
+		while (shardIndex < m_shardCount
+			   && faceCount * m_shardCount >= totalFaceCount * shardIndex) {
+			m_bounds[shardIndex] = i + 1;
+			shardIndex++;
+		}
+	}
+}
+
+TopoDS_Shape ShapeSharder::GetShard(int shardIndex) const {
+	TopoDS_Compound compound;
+	BRep_Builder builder;
+	builder.MakeCompound(compound);
+
+	for (int i = GetSolidBegin(shardIndex); i < GetSolidEnd(shardIndex); ++i)
+		builder.Add(compound, m_solids[i]);
+
+	if (shardIndex == m_shardCount - 1) {
+		for (const auto& face : m_freeFaces)
+			builder.Add(compound, face);
+	}
+
+	return compound;
+}
\ No newline at end of file
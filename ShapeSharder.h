@@ -0,0 +1,28 @@
+#pragma once
+
+// Stable partition of a root shape into contiguous runs of solids.
+// Runs are balanced by face count and follow the TopExp_Explorer order,
+// so concatenating the shards in index order gives back the original order.
+// Faces outside of any solid go to the last shard.
+class ShapeSharder {
+public:
+	ShapeSharder(const TopoDS_Shape& shape, int shardCount);
+	~ShapeSharder(void);
+
+	TopoDS_Shape GetShard(int shardIndex) const;
+
+	const int GetSolidBegin(int shardIndex) const { return m_bounds[shardIndex]; }
+	const int GetSolidEnd(int shardIndex) const { return m_bounds[shardIndex + 1]; }
+	const int GetSolidSize(void) const { return (int)m_solids.size(); }
+	const int GetShardCount(void) const { return m_shardCount; }
+
+protected:
+	void ComputeBounds(void);
+
+private:
+	int m_shardCount;
+	vector<TopoDS_Shape> m_solids;
+	vector<int> m_faceCounts;	// Faces per solid
+	vector<int> m_bounds;		// Shard k owns the solids [m_bounds[k], m_bounds[k + 1])
+	vector<TopoDS_Shape> m_freeFaces;
+};
\ No newline at end of file
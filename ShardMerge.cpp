@@ -0,0 +1,389 @@
+
+#include <iostream>
+using namespace std;
+
+#include <string>
+#include <vector>
+#include <sstream>
+#include <fstream>
+#include <filesystem>
+#include <algorithm>
+#include <map>
+#include <array>
+#include <cmath>
+
+#include <nlohmann/json.hpp>
+using json = nlohmann::json;
+//-----------------------------------------------------------------------------
+
+namespace fs = std::filesystem;
+
+// Print out the usage
+void PrintUsage(string exe) {
+	cout << endl;
+	cout << "[Usage]" << endl;
+	cout << " " << exe << " --output FILE shard_0.json shard_1.json .." << endl;
+	cout << endl;
+	cout << " Combines the JSON files written by STPCalculator --shard k/N into one model." << endl;
+	cout << endl;
+}
+
+bool LoadShard(const fs::path& filePath, json& shard) {
+	ifstream ifs(filePath);
+	if (!ifs.is_open()) {
+		cout << "Cannot open shard: " << filePath.string() << endl;
+		return false;
+	}
+
+	try {
+		shard = json::parse(ifs);
+	} catch (const json::exception& e) {
+		cout << "Not a valid JSON file: " << filePath.string() << " (" << e.what() << ")" << endl;
+		return false;
+	}
+
+	if (!shard.contains("model")
+		|| !shard["model"].contains("shard")) {
+		cout << "Not a shard output: " << filePath.string() << endl;
+		return false;
+	}
+
+	// The partition fields are read without further checks when the shards are sorted and compared
+	const json& shardInfo = shard["model"]["shard"];
+	for (const string key : { "index", "count", "solidBegin", "solidEnd" }) {
+		if (!shardInfo.contains(key)
+			|| !shardInfo[key].is_number_integer()) {
+			cout << "Missing shard " << key << ": " << filePath.string() << endl;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Check that every shard of the same partition is present exactly once and sort them by index
+bool CheckShards(vector<json>& shards) {
+	sort(shards.begin(), shards.end(), [](const json& a, const json& b) {
+		return a["model"]["shard"]["index"].get<int>() < b["model"]["shard"]["index"].get<int>();
+	});
+
+	int shardCount = (int)shards.size();
+
+	for (int i = 0; i < shardCount; ++i) {
+		const json& shard = shards[i]["model"]["shard"];
+
+		if (shard["count"].get<int>() != shardCount) {
+			cout << "Expected " << shard["count"].get<int>() << " shards, got " << shardCount << endl;
+			return false;
+		}
+
+		if (shard["index"].get<int>() != i) {
+			cout << "Shard " << i << " is missing or duplicated" << endl;
+			return false;
+		}
+
+		if (i > 0
+			&& shard["solidBegin"].get<int>() != shards[i - 1]["model"]["shard"]["solidEnd"].get<int>()) {
+			cout << "Shards " << i - 1 << " and " << i << " do not come from the same partition" << endl;
+			return false;
+		}
+	}
+
+	return true;
+}
+
+// Move the indexes of a "coordIndex" or "edgeIndex" string by delta, keeping the -1 separators
+string RebaseIndex(const string& indexes, int delta) {
+	if (delta == 0)
+		return indexes;
+
+	istringstream iss(indexes);
+	ostringstream oss;
+	int index = 0;
+
+	while (iss >> index) {
+		if (index != -1)
+			index += delta;
+
+		oss << index << " ";
+	}
+
+	return oss.str();
+}
+
+void MergeBoundingBox(json& merged, const json& boundingBox) {
+	if (boundingBox.empty())
+		return;
+
+	if (merged.empty()) {
+		merged = boundingBox;
+		return;
+	}
+
+	for (const string key : { "xMin", "yMin", "zMin" })
+		merged[key] = min(merged[key].get<double>(), boundingBox.at(key).get<double>());
+
+	for (const string key : { "xMax", "yMax", "zMax" })
+		merged[key] = max(merged[key].get<double>(), boundingBox.at(key).get<double>());
+}
+
+void MergeMeshList(json& merged, const json& meshes) {
+	// Coordinates of all meshes of a shape share one index space
+	int mergedCoordCount = 0;
+	int mergedNormalCount = 0;
+	for (const auto& mesh : merged) {
+		mergedCoordCount += (int)mesh["coordinates"].size();
+		mergedNormalCount += (int)mesh.value("normals", json::array()).size();
+	}
+
+	int prevCoordCount = 0;
+	int prevNormalCount = 0;
+	for (const auto& mesh : meshes) {
+		json mergedMesh = mesh;
+		int delta = mergedCoordCount - prevCoordCount;
+
+		mergedMesh["coordIndex"] = RebaseIndex(mesh.at("coordIndex").get<string>(), delta);
+		mergedMesh["edgeIndex"] = RebaseIndex(mesh.at("edgeIndex").get<string>(), delta);
+
+		int coordCount = (int)mesh.at("coordinates").size();
+		prevCoordCount += coordCount;
+		mergedCoordCount += coordCount;
+
+		// Normals have their own index space
+		if (mesh.contains("normals")) {
+			mergedMesh["normalIndex"] = RebaseIndex(mesh.at("normalIndex").get<string>(), mergedNormalCount - prevNormalCount);
+
+			int normalCount = (int)mesh["normals"].size();
+			prevNormalCount += normalCount;
+			mergedNormalCount += normalCount;
+		}
+
+		merged.push_back(mergedMesh);
+	}
+}
+
+// Combine the centers of mass and move both inertia tensors to the common one, as MassProperties::Add does
+void MergeMassProperties(json& merged, const json& shape) {
+	double mergedVolume = merged["volume"].get<double>();
+	double shapeVolume = shape.at("volume").get<double>();
+	double volume = mergedVolume + shapeVolume;
+
+	merged["area"] = merged.value("area", 0.0) + shape.value("area", 0.0);
+
+	json& mergedSolids = merged["solids"];
+	for (const auto& solid : shape.value("solids", json::array()))
+		mergedSolids.push_back(solid);
+
+	if (!shape.contains("centerOfMass"))
+		return;
+
+	if (!merged.contains("centerOfMass")
+		|| abs(mergedVolume) <= 1.0e-7) {
+		merged["centerOfMass"] = shape["centerOfMass"];
+		merged["inertia"] = shape.at("inertia");
+		return;
+	}
+
+	if (abs(volume) <= 1.0e-7)
+		return;
+
+	auto toArray = [](const json& point) {
+		return array<double, 3>{ point.at("x").get<double>(), point.at("y").get<double>(), point.at("z").get<double>() };
+	};
+
+	array<double, 3> mergedCenter = toArray(merged["centerOfMass"]);
+	array<double, 3> shapeCenter = toArray(shape["centerOfMass"]);
+	array<double, 3> center;
+	for (int i = 0; i < 3; ++i)
+		center[i] = (mergedCenter[i] * mergedVolume + shapeCenter[i] * shapeVolume) / volume;
+
+	// Parallel axis theorem, I + m * (|d|^2 E - d d^T)
+	auto shiftInertia = [&center](const json& inertia, double mass, const array<double, 3>& point) {
+		array<double, 3> d = { point[0] - center[0], point[1] - center[1], point[2] - center[2] };
+		double squareOffset = d[0] * d[0] + d[1] * d[1] + d[2] * d[2];
+
+		vector<double> shifted = inertia.get<vector<double>>();
+		for (int i = 0; i < 3; ++i) {
+			for (int j = 0; j < 3; ++j)
+				shifted[3 * i + j] += mass * ((i == j ? squareOffset : 0.0) - d[i] * d[j]);
+		}
+
+		return shifted;
+	};
+
+	vector<double> inertia = shiftInertia(merged["inertia"], mergedVolume, mergedCenter);
+	vector<double> shapeInertia = shiftInertia(shape.at("inertia"), shapeVolume, shapeCenter);
+	for (int i = 0; i < 9; ++i)
+		inertia[i] += shapeInertia[i];
+
+	merged["centerOfMass"] = { { "x", center[0] }, { "y", center[1] }, { "z", center[2] } };
+	merged["inertia"] = inertia;
+}
+
+void MergeShape(json& merged, const json& shape) {
+	MergeMassProperties(merged, shape);
+	merged["volume"] = merged["volume"].get<double>() + shape.at("volume").get<double>();
+
+	// Oriented boxes need the nodes of all shards, only a single contribution keeps its box
+	if (merged["mesh"].empty())
+		merged["orientedBoundingBox"] = shape.value("orientedBoundingBox", json::object());
+	else
+		merged["orientedBoundingBox"] = json::object();
+
+	MergeMeshList(merged["mesh"], shape.at("mesh"));
+
+	// Levels of detail are merged level by level like the full meshes
+	if (!shape.contains("lods"))
+		return;
+
+	json& mergedLods = merged["lods"];
+	for (const auto& lod : shape["lods"]) {
+		auto lodIt = find_if(mergedLods.begin(), mergedLods.end(), [&lod](const json& mergedLod) {
+			return mergedLod["level"] == lod.at("level");
+		});
+
+		if (lodIt == mergedLods.end()) {
+			mergedLods.push_back({ { "level", lod.at("level") }, { "mesh", json::array() } });
+			lodIt = mergedLods.end() - 1;
+		}
+
+		MergeMeshList((*lodIt)["mesh"], lod.at("mesh"));
+	}
+}
+
+json MergeShards(const vector<json>& shards) {
+	json mergedModel = json::object();
+	json boundingBox = json::object();
+	json components = json::array();
+	json appearances = json::array();
+	map<string, int> appearanceIDMap;	// Serialized properties to merged ID
+	int degradedFaceCount = 0;
+
+	for (const auto& shard : shards) {
+		const json& model = shard.at("model");
+		MergeBoundingBox(boundingBox, model.value("boundingBox", json::object()));
+		degradedFaceCount += model.value("degradedFaceCount", 0);
+
+		// Each shard numbers its appearances from 0, map them to the merged list
+		vector<int> appearanceIDs;
+		for (const auto& appearance : model.value("appearances", json::array())) {
+			auto result = appearanceIDMap.try_emplace(appearance.dump(), (int)appearances.size());
+			if (result.second)
+				appearances.push_back(appearance);
+
+			appearanceIDs.push_back(result.first->second);
+		}
+
+		// Components and shapes are matched by name, empty shards have none
+		for (const auto& comp : model.value("components", json::array())) {
+			auto compIt = find_if(components.begin(), components.end(), [&comp](const json& mergedComp) {
+				return mergedComp["componentName"] == comp.at("componentName");
+			});
+
+			if (compIt == components.end()) {
+				json mergedComp = comp;
+				mergedComp["shapes"] = json::array();
+				components.push_back(mergedComp);
+				compIt = components.end() - 1;
+			} else
+				(*compIt)["orientedBoundingBox"] = json::object();
+
+			json& mergedShapes = (*compIt)["shapes"];
+
+			for (json shape : comp.at("shapes")) {
+				if (shape.contains("appearanceID"))
+					shape["appearanceID"] = appearanceIDs.at(shape["appearanceID"].get<int>());
+
+				auto shapeIt = find_if(mergedShapes.begin(), mergedShapes.end(), [&shape](const json& mergedShape) {
+					return mergedShape["shapeName"] == shape["shapeName"];
+				});
+
+				if (shapeIt == mergedShapes.end()) {
+					json mergedShape = shape;
+					mergedShape["volume"] = 0.0;
+					mergedShape["area"] = 0.0;
+					mergedShape["solids"] = json::array();
+					mergedShape.erase("centerOfMass");
+					mergedShape.erase("inertia");
+					mergedShape["mesh"] = json::array();
+					if (mergedShape.contains("lods"))
+						mergedShape["lods"] = json::array();
+					mergedShapes.push_back(mergedShape);
+					shapeIt = mergedShapes.end() - 1;
+				}
+
+				MergeShape(*shapeIt, shape);
+			}
+		}
+	}
+
+	// Number the shapes as Model::UpdateGlobalIShapeIndex does for a single run
+	int globalIndex = 1;
+	for (auto& comp : components) {
+		for (auto& shape : comp["shapes"]) {
+			shape["globalIndex"] = globalIndex;
+			globalIndex++;
+		}
+	}
+
+	mergedModel["boundingBox"] = boundingBox;
+	mergedModel["components"] = components;
+	mergedModel["appearances"] = appearances;
+	mergedModel["degradedFaceCount"] = degradedFaceCount;
+
+	json jsonContainer = json::object();
+	jsonContainer["model"] = mergedModel;
+
+	return jsonContainer;
+}
+
+int main(int argc, char** argv) {
+	fs::path outputPath;
+	vector<fs::path> shardPaths;
+
+	// Set options
+	for (int i = 1; i < argc; ++i) {
+		string token(argv[i]);
+
+		if (token == "--output"
+			&& i + 1 < argc)
+			outputPath = argv[++i];
+		else
+			shardPaths.push_back(token);
+	}
+
+	if (outputPath.empty()
+		|| shardPaths.empty()) {
+		PrintUsage(argv[0]);
+		return -1;
+	}
+
+	vector<json> shards;
+	for (const auto& shardPath : shardPaths) {
+		json shard;
+		if (!LoadShard(shardPath, shard))
+			return -1;
+
+		shards.push_back(shard);
+	}
+
+	// A truncated or edited shard can still miss mesh fields
+	json merged;
+	try {
+		if (!CheckShards(shards))
+			return -1;
+
+		merged = MergeShards(shards);
+	} catch (const json::exception& e) {
+		cout << "Cannot merge the shards: " << e.what() << endl;
+		return -1;
+	}
+
+	ofstream ofs(outputPath);
+	ofs << merged.dump();
+	ofs.close();
+
+	cout << "Merged " << shards.size() << " shards into " << outputPath.string() << endl;
+
+	return 0;
+}
\ No newline at end of file
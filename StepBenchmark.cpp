@@ -0,0 +1,223 @@
+
+#include "CommonImport.h"
+#include "StepReader.h"
+#include "Tessellator.h"
+#include "JsonWriter.h"
+#include "Component.h"
+#include "IShape.h"
+#include "Mesh.h"
+#include "MemoryReport.h"
+#include <chrono>
+#include <fstream>
+//-----------------------------------------------------------------------------
+
+namespace fs = std::filesystem;
+typedef chrono::steady_clock BenchClock;
+
+// Peak of the whole run, kept here since every stage restarts the process peak where it can
+size_t g_peakWorkingSet = 0;
+
+// Working set at the start of a stage
+struct StageMemory {
+	size_t workingSet = 0;
+	bool isPeakReset = false;
+};
+
+// Print out the usage
+void PrintUsage(string exe) {
+	cout << endl;
+	cout << "[Usage]" << endl;
+	cout << " " << exe << " --corpus DIR [--output FILE]" << endl;
+	cout << endl;
+	cout << "[Options]" << endl;
+	cout << " --corpus   Directory holding the STEP files to benchmark" << endl;
+	cout << " --output   JSON results file (default bench_results.json)" << endl;
+	cout << endl;
+}
+
+double GetSeconds(const BenchClock::time_point& start) {
+	return chrono::duration<double>(BenchClock::now() - start).count();
+}
+
+double GetMegaBytes(size_t bytes) {
+	return bytes / (1024.0 * 1024.0);
+}
+
+size_t GetMemory(OSD_MemInfo::Counter counter) {
+	return MemoryReport::GetMemory(counter);
+}
+
+StageMemory StartStage(void) {
+	g_peakWorkingSet = max(g_peakWorkingSet, GetMemory(OSD_MemInfo::MemWorkingSetPeak));
+
+	StageMemory stageMemory;
+	stageMemory.isPeakReset = MemoryReport::ResetPeak();
+	stageMemory.workingSet = GetMemory(OSD_MemInfo::MemWorkingSet);
+
+	return stageMemory;
+}
+
+json GetStage(double seconds, const StageMemory& stageMemory) {
+	size_t workingSet = GetMemory(OSD_MemInfo::MemWorkingSet);
+	size_t peakWorkingSet = GetMemory(OSD_MemInfo::MemWorkingSetPeak);
+	g_peakWorkingSet = max(g_peakWorkingSet, peakWorkingSet);
+
+	json stage = json::object();
+	stage["seconds"] = seconds;
+	stage["workingSetMB"] = GetMegaBytes(workingSet);
+	stage["workingSetRiseMB"] = GetMegaBytes(workingSet) - GetMegaBytes(stageMemory.workingSet);
+
+	// The process peak only covers this stage once it has been restarted
+	if (stageMemory.isPeakReset)
+		stage["peakRiseMB"] = GetMegaBytes(peakWorkingSet > stageMemory.workingSet ? peakWorkingSet - stageMemory.workingSet : 0);
+
+	return stage;
+}
+
+void CountModel(Model* model, int& faceCount, int& triangleCount) {
+	faceCount = 0;
+	triangleCount = 0;
+
+	vector<Component*> comps;
+	model->GetAllComponents(comps);
+
+	for (const auto& comp : comps) {
+		for (int i = 0; i < comp->GetIShapeSize(); ++i) {
+			IShape* iShape = comp->GetIShapeAt(i);
+
+			TopExp_Explorer ExpFace;
+			for (ExpFace.Init(iShape->GetShape(), TopAbs_FACE); ExpFace.More(); ExpFace.Next())
+				faceCount++;
+
+			for (int j = 0; j < iShape->GetMeshSize(); ++j)
+				triangleCount += iShape->GetMeshAt(j)->GetFaceIndexSize();
+		}
+	}
+}
+
+json RunBenchmark(const fs::path& stepPath, const fs::path& workDir) {
+	json result = json::object();
+	result["file"] = stepPath.filename().string();
+
+	size_t inputSize = fs::file_size(stepPath);
+	result["inputMB"] = GetMegaBytes(inputSize);
+
+	InputOptions opt;
+	opt.SetInput(stepPath.wstring());
+	opt.SetOutput((workDir / stepPath.stem()).replace_extension(".json").wstring());
+
+	Model* model = new Model();
+
+	/** READ **/
+	StageMemory stageMemory = StartStage();
+	BenchClock::time_point start = BenchClock::now();
+	StepReader sr(&opt);
+	bool isRead = sr.ReadSTEP(model);
+	double readTime = GetSeconds(start);
+	json readStage = GetStage(readTime, stageMemory);
+
+	if (!isRead) {
+		result["error"] = "Reading has failed";
+		delete model;
+		return result;
+	}
+
+	readStage["MBPerSecond"] = GetMegaBytes(inputSize) / readTime;
+
+	/** TESSELLATE **/
+	stageMemory = StartStage();
+	start = BenchClock::now();
+	Tessellator ts(&opt);
+	ts.Tessellate(model);
+	double tessellateTime = GetSeconds(start);
+	json tessellateStage = GetStage(tessellateTime, stageMemory);
+
+	int faceCount = 0, triangleCount = 0;
+	CountModel(model, faceCount, triangleCount);
+	tessellateStage["facesPerSecond"] = faceCount / tessellateTime;
+	tessellateStage["trianglesPerSecond"] = triangleCount / tessellateTime;
+
+	/** WRITE **/
+	stageMemory = StartStage();
+	start = BenchClock::now();
+	JsonWriter jw(&opt);
+	jw.WriteJson(model);
+	double writeTime = GetSeconds(start);
+	json writeStage = GetStage(writeTime, stageMemory);
+
+	size_t outputSize = fs::file_size(opt.GetOutputJson());
+	writeStage["MBPerSecond"] = GetMegaBytes(outputSize) / writeTime;
+
+	result["faces"] = faceCount;
+	result["triangles"] = triangleCount;
+	result["outputMB"] = GetMegaBytes(outputSize);
+	result["read"] = readStage;
+	result["tessellate"] = tessellateStage;
+	result["write"] = writeStage;
+	result["totalSeconds"] = readTime + tessellateTime + writeTime;
+
+	delete model;
+	fs::remove(opt.GetOutputJson());
+
+	return result;
+}
+
+int main(int argc, char** argv) {
+	fs::path corpusDir;
+	fs::path resultPath = "bench_results.json";
+
+	// Set options
+	for (int i = 1; i + 1 < argc; i += 2) {
+		string token(argv[i]);
+		string value(argv[i + 1]);
+
+		if (token == "--corpus")
+			corpusDir = value;
+		else if (token == "--output")
+			resultPath = value;
+		else {
+			cout << "No such option: " << token << endl;
+			return -1;
+		}
+	}
+
+	if (corpusDir.empty()
+		|| !fs::is_directory(corpusDir)) {
+		PrintUsage(argv[0]);
+		return -1;
+	}
+
+	// Run the corpus in a stable order
+	vector<fs::path> stepPaths;
+	for (const auto& entry : fs::directory_iterator(corpusDir)) {
+		string ext = entry.path().extension().string();
+		transform(ext.begin(), ext.end(), ext.begin(), ::tolower);
+
+		if (ext == ".stp"
+			|| ext == ".step")
+			stepPaths.push_back(entry.path());
+	}
+	sort(stepPaths.begin(), stepPaths.end());
+
+	fs::path workDir = fs::temp_directory_path() / "stpcalc_bench";
+	fs::create_directories(workDir);
+
+	json results = json::object();
+	json fileResults = json::array();
+
+	for (const auto& stepPath : stepPaths) {
+		cout << "Benchmarking " << stepPath.filename().string() << ".." << endl;
+		fileResults.push_back(RunBenchmark(stepPath, workDir));
+	}
+
+	results["files"] = fileResults;
+	results["peakWorkingSetMB"] = GetMegaBytes(max(g_peakWorkingSet, GetMemory(OSD_MemInfo::MemWorkingSetPeak)));
+
+	ofstream of(resultPath);
+	of << results.dump(2);
+	of.close();
+
+	cout << "Benchmark results written to " << resultPath.string() << endl;
+
+	return 0;
+}
@@ -5,10 +5,30 @@
 #include "X3D_Writer.h"
 #include "JsonWriter.h"
 #include "Component.h"
+#include "ProgressIndicator.h"
+#include "StepScanner.h"
+#include "FolderWatcher.h"
+#include "MemoryReport.h"
 #include <fstream>
+#include <csignal>
 //-----------------------------------------------------------------------------
 
 namespace fs = std::filesystem;
+
+// Progress of the running translation, cancelled by SIGTERM
+static ProgressIndicator* g_progress = nullptr;
+
+// Watch of the input directory, stopped by SIGTERM
+static FolderWatcher* g_watcher = nullptr;
+
+void HandleTerminate(int signal) {
+	if (g_progress)
+		g_progress->Cancel();
+
+	if (g_watcher)
+		g_watcher->Stop();
+}
+
 // Print out the usage
 void PrintUsage(wstring exe, InputOptions* opt) {
 	cout << endl;
@@ -22,6 +42,28 @@ void PrintUsage(wstring exe, InputOptions* opt) {
 	cout << "[Options]" << endl;
 	cout << " --input      Input STEP file path" << endl;
 	cout << " --output     Output JSON path default=" << opt->GetOutputJson().c_str() << endl;
+	cout << " --face-report N  Time every face and print the N worst ones" << endl;
+	cout << " --bounds brep|mesh  Bounding boxes of the B-rep (default) or of the mesh nodes" << endl;
+	cout << " --normals on|off  Write vertex normals (default off)" << endl;
+	cout << " --crease-angle A  Radians up to which averaged normals are smoothed default=0.2" << endl;
+	cout << " --vertex-cache N  Reorder triangles and vertices for a vertex cache of N entries" << endl;
+	cout << " --deflection global|adaptive  One deflection from the root box (default) or one per solid and face" << endl;
+	cout << " --triangle-budget N  Scale the adaptive deflection until the model has about N triangles" << endl;
+	cout << " --max-triangles N  Coarsen the heaviest faces once the model has more than N triangles" << endl;
+	cout << " --max-face-triangles N  Coarsen faces with more than N triangles" << endl;
+	cout << " --time-limit S  Mesh the faces left after S seconds at a coarse deflection" << endl;
+	cout << " --face-time-limit S  Seconds allowed for a face meshed on its own" << endl;
+	cout << " --progress on|off  Print the stage and progress every ten percent (default off)" << endl;
+	cout << " --transfer-threads N  Transfer the STEP roots on N threads, 0 = all processors (default 1). Each thread parses its own copy of the file, so parse time and model memory grow N times. Needs OCCT 7.8 or later, earlier versions transfer on one thread" << endl;
+	cout << " --watch on|off  Convert STEP files written to the --input directory into the --output directory until SIGTERM" << endl;
+	cout << " --watch-jobs N  Files converted at the same time in watch mode, read one at a time and tessellated and written side by side (default 1)" << endl;
+	cout << " --scan on|off  Only write the header, entity counts and cost estimate of the STEP file" << endl;
+	cout << " --lod N  Add N simplified levels of detail (1-4), each with half the triangles" << endl;
+	cout << " --mass-tolerance EPS  Relative error of the volume, area and inertia integration (default fixed Gauss points)" << endl;
+	cout << " --mesh-cache DIR  Reuse the meshes and volumes of solids unchanged since an earlier run" << endl;
+	cout << " --mem-report on|off  Add the working set of each stage and the bytes of the meshes to the output" << endl;
+	cout << " --trace FILE  Write the time spans of the stages as a Chrome trace, opened in Perfetto" << endl;
+	cout << " --shard k/N  Process only shard k of N of the root solids (see stpcalc_merge)" << endl;
 	cout << endl;
 	cout << "[Examples]" << endl;
 	wcout << " " << exe << " --input Model.stp --Output C:\\Desktop" << endl;
@@ -39,28 +81,30 @@ bool SetOption(int argc, char* argv[], InputOptions* opt) {
 		//cout << "WRONG USAGE" << std::endl;
 		return false;
 	}
-	bool inputFlag = false;
 
 	// Set options
 	for (int i = 1; i < argc; ++i) {
 		string stoken(argv[i]);
 		wstring token = StrTool::s2ws(stoken);
 
+		if (i + 1 >= argc) {
+			wcout << "Missing value for option: " << token << endl;
+			return false;
+		}
+
 		string stoken1(argv[i + 1]);
 		wstring token1 = StrTool::s2ws(stoken1);
 
-		if (token != L"--input" && token != L"--output") {
-			wcout << "No such option: " << token << endl;
+		// Numbers that do not parse throw from stoi and stod
+		try {
+			if (!opt->SetOption(token, token1))
+				return false;
+		} catch (const exception&) {
+			wcout << "Invalid value for option " << token << ": " << token1 << endl;
+			PrintUsage(StrTool::s2ws(string(argv[0])), opt);
 			return false;
-		} else {
-			if (token == L"--input") {
-				inputFlag = true;
-				opt->SetInput(token1);
-			} else if (token == L"--output") {
-				opt->SetOutput(token1);
-			}
-			++i;
 		}
+		++i;
 	}
 
 	// Check input path
@@ -74,38 +118,93 @@ bool SetOption(int argc, char* argv[], InputOptions* opt) {
 			   && !fs::is_regular_file(opt->GetInput())) {
 		wcout << "No such file or directory: " << opt->GetInput() << endl;
 		return false;
+	} else if (opt->GetWatch()
+			   && !fs::is_directory(opt->GetInput())) {
+		wcout << "Watch mode needs an input directory: " << opt->GetInput() << endl;
+		return false;
 	}
 
 	return true;
 }
-int RunSTP2X3D(InputOptions* opt) {
+
+// Pre-scan for scheduling, without reading the STEP file through OpenCascade
+int RunScan(InputOptions* opt) {
+	StopWatch sw;
+	sw.Start();
+
+	cout << "Scanning a STEP file.." << endl;
+	StepScanner sc;
+	if (!sc.ScanFile(opt->GetInput()))
+		return -1;
+
+	ofstream ofs(fs::path(opt->GetOutputJson()));
+	if (!ofs.is_open()) {
+		wcout << "Cannot write: " << opt->GetOutputJson() << endl;
+		return -1;
+	}
+
+	// Bytes that are not UTF-8, such as raw Latin-1 names, are replaced rather than failing the dump
+	ofs << sc.GetJson().dump(-1, ' ', false, json::error_handler_t::replace);
+	ofs.close();
+
+	cout << "\tEntities: " << sc.GetEntitySize() << ", faces: " << sc.GetFaceSize() << ", solids: " << sc.GetSolidSize() << endl;
+	cout << "\tEstimated cost: " << sc.GetCost() << endl;
+	sw.End();
+
+	return 0;
+}
+
+int RunSTP2X3D(InputOptions* opt, const Handle(ProgressIndicator)& progress) {
 	Model* model = new Model();
 
 	StopWatch sw;
 	sw.Start();
 
+	MemoryReport memoryReport;
+	if (opt->GetMemReport())
+		memoryReport.Start(opt->GetInput());
+
+	// Stages weighted by their usual share of the run time
+	Message_ProgressScope scope(progress->Start(), "STEP to JSON", 10);
+
 	/** START_STEP **/
 	cout << "Reading a STEP file.." << endl;
 	StepReader sr(opt);
-	if (!sr.ReadSTEP(model)) {
+	if (!sr.ReadSTEP(model, scope.Next(3))) {
 		delete model;
-		return -1;
+		return progress->IsCancelled() ? -2 : -1;
 	}
 	/** END_STEP **/
 	sw.Lap();
 
+	if (opt->GetMemReport())
+		memoryReport.EndStage("read");
+
 	/** START_TESSELLATION **/
 	cout << "Tessellating.." << endl;
 	Tessellator* ts = new Tessellator(opt);
-	ts->Tessellate(model);
+	bool isTessellated = ts->Tessellate(model, scope.Next(6));
 	delete ts;
 	/** END_TESSELLATION **/
 	sw.Lap();
-	
+
+	if (opt->GetMemReport()) {
+		memoryReport.EndStage("tessellate");
+		memoryReport.AddModel(model);
+	}
+
 	///** START_JSON **/
 	//cout << "Writing an Json file.." << endl;
 	JsonWriter jw(opt);
-	jw.WriteJson(model);
+	if (opt->GetMemReport())
+		jw.SetMemoryReport(&memoryReport);
+
+	if (!isTessellated
+		|| !jw.WriteJson(model, scope.Next(1))) {
+		cout << "STEP to JSON cancelled" << endl;
+		delete model;
+		return -2;
+	}
 	///** END_JSON **/
 	//sw.Lap();
 	///** START_X3D **/
@@ -124,6 +223,11 @@ int RunSTP2X3D(InputOptions* opt) {
 	//}
 	///
 
+	if (opt->GetMemReport()) {
+		memoryReport.EndStage("write");
+		memoryReport.Print();
+	}
+
 	cout << "STEP to JSON completed!" << endl;
 	sw.End();
 
@@ -132,6 +236,30 @@ int RunSTP2X3D(InputOptions* opt) {
 	return 0;
 }
 
+// Convert the STEP files dropped into the input directory until SIGTERM, one JSON per file in the output directory
+int RunWatch(InputOptions* opt) {
+	fs::path outputDirectory(opt->GetOutputDirectory());
+
+	error_code ec;
+	fs::create_directories(outputDirectory, ec);
+
+	FolderWatcher watcher(opt->GetInput(), opt->GetWatchJobs(), [opt, &outputDirectory](const fs::path& filePath) {
+		InputOptions fileOpt = *opt;
+		fileOpt.SetInput(filePath.wstring());
+		fileOpt.SetOutput((outputDirectory / filePath.stem()).wstring() + L".json");
+
+		// Each conversion has its own progress, SIGTERM only stops the watch
+		Handle(ProgressIndicator) progress = new ProgressIndicator(fileOpt.GetProgress());
+		return RunSTP2X3D(&fileOpt, progress) == 0;
+	});
+
+	g_watcher = &watcher;
+	bool isDone = watcher.Run();
+	g_watcher = nullptr;
+
+	return isDone ? 0 : -1;
+}
+
 int main(int argc, char** argv) {
 	InputOptions opt; // Option for STEP to X3D translator
 
@@ -145,6 +273,24 @@ int main(int argc, char** argv) {
 		return status;
 #endif
 
-	status = RunSTP2X3D(&opt);
+	signal(SIGTERM, HandleTerminate);
+
+	if (!opt.GetTrace().empty())
+		TraceRecorder::Instance().Start();
+
+	if (opt.GetWatch())
+		status = RunWatch(&opt);
+	else if (opt.GetScan())
+		status = RunScan(&opt);
+	else {
+		Handle(ProgressIndicator) progress = new ProgressIndicator(opt.GetProgress());
+		g_progress = progress.get();
+		status = RunSTP2X3D(&opt, progress);
+		g_progress = nullptr;
+	}
+
+	if (!opt.GetTrace().empty())
+		TraceRecorder::Instance().Write(opt.GetTrace());
+
 	return status;
 }
@@ -0,0 +1,173 @@
+
+#include "CommonImport.h"
+
+#include <BRepPrimAPI_MakeBox.hxx>
+#include <BRepPrimAPI_MakeCylinder.hxx>
+#include <BRepFilletAPI_MakeFillet.hxx>
+#include <BRepBuilderAPI_MakeFace.hxx>
+#include <GeomAPI_PointsToBSplineSurface.hxx>
+#include <Geom_BSplineSurface.hxx>
+#include <TColgp_Array2OfPnt.hxx>
+#include <STEPControl_Writer.hxx>
+//-----------------------------------------------------------------------------
+
+namespace fs = std::filesystem;
+
+// Print out the usage
+void PrintUsage(string exe) {
+	cout << endl;
+	cout << "[Usage]" << endl;
+	cout << " " << exe << " --output DIR [--count N] [--resolution N]" << endl;
+	cout << endl;
+	cout << "[Options]" << endl;
+	cout << " --output      Directory receiving the generated STEP files" << endl;
+	cout << " --count       Parts per pattern side, N x N parts per file (default 4)" << endl;
+	cout << " --resolution  Control points per side of a B-spline patch (default 16)" << endl;
+	cout << endl;
+}
+
+// Copy a part on a count x count grid (geometry is duplicated)
+TopoDS_Shape MakeGrid(const TopoDS_Shape& part, int count, double pitch) {
+	TopoDS_Compound compound;
+	BRep_Builder builder;
+	builder.MakeCompound(compound);
+
+	for (int i = 0; i < count; ++i) {
+		for (int j = 0; j < count; ++j) {
+			gp_Trsf trsf;
+			trsf.SetTranslation(gp_Vec(i * pitch, j * pitch, 0.0));
+			builder.Add(compound, BRepBuilderAPI_Transform(part, trsf, true).Shape());
+		}
+	}
+
+	return compound;
+}
+
+// Instance a part on a count x count grid (geometry is shared through locations)
+TopoDS_Shape MakePattern(const TopoDS_Shape& part, int count, double pitch) {
+	TopoDS_Compound compound;
+	BRep_Builder builder;
+	builder.MakeCompound(compound);
+
+	for (int i = 0; i < count; ++i) {
+		for (int j = 0; j < count; ++j) {
+			gp_Trsf trsf;
+			trsf.SetTranslation(gp_Vec(i * pitch, j * pitch, 0.0));
+			builder.Add(compound, part.Moved(TopLoc_Location(trsf)));
+		}
+	}
+
+	return compound;
+}
+
+TopoDS_Shape MakeBox(void) {
+	return BRepPrimAPI_MakeBox(10.0, 10.0, 10.0).Shape();
+}
+
+TopoDS_Shape MakeCylinder(void) {
+	gp_Ax2 axis(gp_Pnt(5.0, 5.0, 0.0), gp_Dir(0.0, 0.0, 1.0));
+	return BRepPrimAPI_MakeCylinder(axis, 4.0, 12.0).Shape();
+}
+
+TopoDS_Shape MakeFilletedBox(void) {
+	const TopoDS_Shape& box = MakeBox();
+	BRepFilletAPI_MakeFillet fillet(box);
+
+	TopExp_Explorer ExpEdge;
+	for (ExpEdge.Init(box, TopAbs_EDGE); ExpEdge.More(); ExpEdge.Next())
+		fillet.Add(1.0, TopoDS::Edge(ExpEdge.Current()));
+
+	return fillet.Shape();
+}
+
+TopoDS_Shape MakeBSplinePatch(int resolution) {
+	// Wavy patch interpolating resolution x resolution points
+	TColgp_Array2OfPnt points(1, resolution, 1, resolution);
+	double size = 10.0;
+	double step = size / (resolution - 1);
+
+	for (int i = 1; i <= resolution; ++i) {
+		for (int j = 1; j <= resolution; ++j) {
+			double x = (i - 1) * step;
+			double y = (j - 1) * step;
+			double z = sin(x * 0.7) * cos(y * 0.5) * 1.5;
+			points.SetValue(i, j, gp_Pnt(x, y, z));
+		}
+	}
+
+	GeomAPI_PointsToBSplineSurface approx(points);
+	const Handle(Geom_BSplineSurface)& surface = approx.Surface();
+
+	return BRepBuilderAPI_MakeFace(surface, Precision::Confusion()).Shape();
+}
+
+TopoDS_Shape MakeAssembly(int count, int resolution) {
+	// Subassembly of every primitive, instanced on a grid
+	TopoDS_Compound subAssembly;
+	BRep_Builder builder;
+	builder.MakeCompound(subAssembly);
+
+	gp_Trsf trsf;
+	builder.Add(subAssembly, MakeBox());
+	trsf.SetTranslation(gp_Vec(15.0, 0.0, 0.0));
+	builder.Add(subAssembly, MakeCylinder().Moved(TopLoc_Location(trsf)));
+	trsf.SetTranslation(gp_Vec(0.0, 15.0, 0.0));
+	builder.Add(subAssembly, MakeFilletedBox().Moved(TopLoc_Location(trsf)));
+	trsf.SetTranslation(gp_Vec(15.0, 15.0, 0.0));
+	builder.Add(subAssembly, MakeBSplinePatch(resolution).Moved(TopLoc_Location(trsf)));
+
+	return MakePattern(subAssembly, count, 40.0);
+}
+
+bool WriteSTEP(const TopoDS_Shape& shape, const fs::path& filePath) {
+	STEPControl_Writer writer;
+
+	if (writer.Transfer(shape, STEPControl_AsIs) != IFSelect_RetDone)
+		return false;
+
+	if (writer.Write(filePath.string().c_str()) != IFSelect_RetDone)
+		return false;
+
+	cout << "Written " << filePath.string() << endl;
+
+	return true;
+}
+
+int main(int argc, char** argv) {
+	fs::path outputDir;
+	int count = 4;
+	int resolution = 16;
+
+	// Set options
+	for (int i = 1; i + 1 < argc; i += 2) {
+		string token(argv[i]);
+		string value(argv[i + 1]);
+
+		if (token == "--output")
+			outputDir = value;
+		else if (token == "--count")
+			count = max(1, stoi(value));
+		else if (token == "--resolution")
+			resolution = max(4, stoi(value));
+		else {
+			cout << "No such option: " << token << endl;
+			return -1;
+		}
+	}
+
+	if (outputDir.empty()) {
+		PrintUsage(argv[0]);
+		return -1;
+	}
+
+	fs::create_directories(outputDir);
+
+	bool isDone = true;
+	isDone &= WriteSTEP(MakeGrid(MakeBox(), count, 20.0), outputDir / "boxes.stp");
+	isDone &= WriteSTEP(MakeGrid(MakeCylinder(), count, 20.0), outputDir / "cylinders.stp");
+	isDone &= WriteSTEP(MakeGrid(MakeFilletedBox(), count, 20.0), outputDir / "fillets.stp");
+	isDone &= WriteSTEP(MakeGrid(MakeBSplinePatch(resolution), count, 20.0), outputDir / "bsplines.stp");
+	isDone &= WriteSTEP(MakeAssembly(count, resolution), outputDir / "assembly.stp");
+
+	return isDone ? 0 : -1;
+}
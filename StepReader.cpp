@@ -2,34 +2,117 @@
 #include "StepReader.h"
 #include "Component.h"
 #include "IShape.h"
+#include "ShapeSharder.h"
+#include <mutex>
+
+// Before OCCT 7.8 every transfer sets process-wide unit factors, so roots are only transferred in parallel from there on
+#if OCC_VERSION_HEX >= 0x070800
+#define PARALLEL_TRANSFER
+#endif
 
 StepReader::StepReader(InputOptions* opt)
 	: m_opt(opt) {}
 
 StepReader::~StepReader(void) {}
 
-bool StepReader::ReadSTEP(Model* model) {
-	IFSelect_ReturnStatus status;
+bool StepReader::ReadSTEP(Model* model, const Message_ProgressRange& range) {
 	wstring filePath = m_opt->GetInput();
+
+	return ReadModel(model, [&filePath](STEPControl_Reader& reader) {
+		TCollection_AsciiString aFileName((const wchar_t*)filePath.c_str());
+		return reader.ReadFile(aFileName.ToCString());
+	}, range);
+}
+
+bool StepReader::ReadSTEP(Model* model, istream& stream, const string& name, const Message_ProgressRange& range) {
+	if (GetTransferThreads() <= 1) {
+		return ReadModel(model, [&stream, &name](STEPControl_Reader& reader) {
+			return reader.ReadStream(name.c_str(), stream);
+		}, range);
+	}
+
+	// Every transfer session parses its own model, so the stream is kept to be read again
+	string content((istreambuf_iterator<char>(stream)), istreambuf_iterator<char>());
+
+	return ReadModel(model, [&content, &name](STEPControl_Reader& reader) {
+		istringstream iss(content);
+		return reader.ReadStream(name.c_str(), iss);
+	}, range);
+}
+
+bool StepReader::ReadModel(Model* model, const function<IFSelect_ReturnStatus(STEPControl_Reader&)>& parse, const Message_ProgressRange& range) {
+	// Reads take turns in the process: OCCT sets signal handlers, initializes the STEP controller on the first
+	// reader and keeps the unit factors of a transfer in globals. Tessellating and writing stay concurrent.
+	static mutex readMutex;
+	lock_guard<mutex> lock(readMutex);
+
+	IFSelect_ReturnStatus status;
 	OSD::SetSignal(false);
+
+	TraceScope trace("ReadSTEP", "step");
+
+	// Parsing reports no progress of its own, the transfer does
+	Message_ProgressScope scope(range, "Reading STEP", 4);
 	try {
 		model->Clear();
 		// Read a STEP file
 		STEPControl_Reader reader;
 
-		TCollection_AsciiString aFileName((const wchar_t*)filePath.c_str());
-		status = reader.ReadFile(aFileName.ToCString());
+		{
+			Message_ProgressScope parseScope(scope.Next(), "Parsing", 1);
+			TraceScope parseTrace("Parse", "step");
+			status = parse(reader);
+		}
 
-		//status = reader.ReadFile(filePath.c_str());
 		if (!CheckReturnStatus(status)) {
 			return false;
 		}
-		if (reader.TransferRoot()) {
-			const TopoDS_Shape& shape = reader.Shape();
-			IShape* iShape = new IShape(shape);
-			Component* rootComp = new Component(shape);
-			rootComp->AddIShape(iShape);
-			model->AddComponent(rootComp);
+
+		// A cancelled range breaks the transfer right away
+		vector<TopoDS_Shape> rootShapes;
+		vector<STEPControl_Reader> sessions;
+		vector<int> rootSessions;
+		bool isTransferred = TransferRoots(reader, parse, rootShapes, sessions, rootSessions, scope.Next(3));
+		if (scope.UserBreak()) {
+			cout << "Reading cancelled" << endl;
+			return false;
+		}
+
+		if (isTransferred) {
+			// Shards split the solids of all roots, which are then handled as one root
+			if (m_opt->IsSharded()) {
+				TopoDS_Compound compound;
+				BRep_Builder builder;
+				builder.MakeCompound(compound);
+
+				for (const auto& rootShape : rootShapes) {
+					if (!rootShape.IsNull())
+						builder.Add(compound, rootShape);
+				}
+
+				TopoDS_Shape shape = rootShapes.size() == 1 ? rootShapes[0] : compound;
+				rootShapes.assign(1, ExtractShard(shape, model));
+				rootSessions.assign(1, 0);
+			}
+
+			// One root component per root, the IShapes of each session share its transfer process
+			vector<vector<IShape*>> sessionIShapes(max(1, (int)sessions.size()));
+			for (int i = 0; i < (int)rootShapes.size(); ++i) {
+				if (!rootShapes[i].IsNull())
+					AddRoot(model, rootShapes[i], sessionIShapes[rootSessions[i]]);
+			}
+
+			// The faces of a shard may come from every session
+			if (m_opt->IsSharded()) {
+				vector<IShape*> shardIShapes = sessionIShapes[0];
+				sessionIShapes.assign(sessionIShapes.size(), shardIShapes);
+			}
+
+			// Entity numbers are only needed to identify faces in the tessellation report
+			if (m_opt->GetFaceReport() > 0) {
+				for (int i = 0; i < (int)sessionIShapes.size(); ++i)
+					MapFaceStepIDs(sessions.empty() ? reader : sessions[i], sessionIShapes[i]);
+			}
 		}
 	} catch (...) {
 		// Unknown failure
@@ -43,6 +126,158 @@ bool StepReader::ReadSTEP(Model* model) {
 	return true;
 }
 
+bool StepReader::TransferRoots(STEPControl_Reader& reader, const function<IFSelect_ReturnStatus(STEPControl_Reader&)>& parse, vector<TopoDS_Shape>& rootShapes,
+							   vector<STEPControl_Reader>& sessions, vector<int>& rootSessions, const Message_ProgressRange& range) const {
+	int rootCount = reader.NbRootsForTransfer();
+	int threadCount = min(GetTransferThreads(), rootCount);
+	if (m_opt->GetTransferThreads() > 1
+		&& GetTransferThreads() <= 1
+		&& rootCount > 1)
+		cout << "\tParallel transfer needs OCCT 7.8 or later, the roots are transferred one after the other" << endl;
+
+	rootShapes.assign(rootCount, TopoDS_Shape());
+	rootSessions.assign(rootCount, 0);
+	sessions.clear();
+
+	Message_ProgressScope scope(range, "Transferring roots", max(1, rootCount));
+
+	if (threadCount <= 1) {
+		for (int i = 0; i < rootCount && scope.More(); ++i) {
+			TraceScope rootTrace("TransferRoot", "step", "root", i + 1);
+			if (reader.TransferRoot(i + 1, scope.Next()))
+				rootShapes[i] = reader.Shape(reader.NbShapes());
+		}
+	}
+#ifdef PARALLEL_TRANSFER
+	else {
+		// OCCT does not guarantee concurrent transfers on one model, each session has a model of its own.
+		// The first one is the reader itself, whose model is already parsed.
+		sessions.reserve(threadCount);
+		sessions.push_back(reader);
+		for (int i = 1; i < threadCount; ++i) {
+			Handle(XSControl_WorkSession) session = new XSControl_WorkSession();
+			sessions.emplace_back(session, true);
+		}
+
+		// Ranges are taken in order here, the transfers then report from their own threads
+		vector<Message_ProgressRange> ranges;
+		for (int i = 0; i < rootCount; ++i)
+			ranges.push_back(scope.Next());
+
+		// Roots differ a lot in size, each session picks the next root once it is done
+		atomic<int> nextRoot(0);
+		OSD_Parallel::For(0, threadCount, [&](int s) {
+			STEPControl_Reader& session = sessions[s];
+
+			// Parsing the same file gives the same roots in the same order
+			try {
+				if (s > 0
+					&& (parse(session) != IFSelect_RetDone
+						|| session.NbRootsForTransfer() != rootCount))
+					return;
+			} catch (...) {
+				return;
+			}
+
+			for (int i = nextRoot++; i < rootCount; i = nextRoot++) {
+				if (ranges[i].UserBreak())
+					break;
+
+				TraceScope rootTrace("TransferRoot", "step", "root", i + 1);
+				rootTrace.SetArg("session", s);
+
+				try {
+					if (session.TransferRoot(i + 1, ranges[i])) {
+						rootShapes[i] = session.Shape(session.NbShapes());
+						rootSessions[i] = s;
+					}
+				} catch (...) {
+					// The other roots are still transferred
+				}
+			}
+		});
+	}
+#else
+	(void)parse;
+#endif
+
+	int transferredCount = (int)count_if(rootShapes.begin(), rootShapes.end(), [](const TopoDS_Shape& shape) {
+		return !shape.IsNull();
+	});
+
+	if (rootCount > 1)
+		cout << "\tTransferred " << transferredCount << " of " << rootCount << " roots" << (threadCount > 1 ? " in parallel" : "") << endl;
+
+	return transferredCount > 0;
+}
+
+int StepReader::GetTransferThreads(void) const {
+#ifdef PARALLEL_TRANSFER
+	return m_opt->GetTransferThreads();
+#else
+	return 1;
+#endif
+}
+
+void StepReader::AddRoot(Model* model, const TopoDS_Shape& shape, vector<IShape*>& iShapes) const {
+	IShape* iShape = model->NewIShape(shape);
+	Component* rootComp = model->NewComponent(shape);
+	rootComp->AddIShape(iShape);
+	model->AddComponent(rootComp);
+
+	iShapes.push_back(iShape);
+}
+
+void StepReader::MapFaceStepIDs(const STEPControl_Reader& reader, const vector<IShape*>& iShapes) const {
+	if (iShapes.empty())
+		return;
+
+	const Handle(Transfer_TransientProcess)& TP = reader.WS()->TransferReader()->TransientProcess();
+	const Handle(Interface_InterfaceModel)& stepModel = reader.Model();
+
+	// Walk the transferred entities once instead of searching per face
+	unordered_map<const TopoDS_TShape*, int> faceStepIDMap;
+	for (int i = 1; i <= TP->NbMapped(); ++i) {
+		const Handle(Standard_Transient)& entity = TP->Mapped(i);
+		const TopoDS_Shape& shape = TransferBRep::ShapeResult(TP, entity);
+
+		if (shape.IsNull()
+			|| shape.ShapeType() != TopAbs_FACE)
+			continue;
+
+		faceStepIDMap[shape.TShape().get()] = stepModel->Number(entity);
+	}
+
+	for (const auto& iShape : iShapes) {
+		TopExp_Explorer ExpFace;
+		for (ExpFace.Init(iShape->GetShape(), TopAbs_FACE); ExpFace.More(); ExpFace.Next()) {
+			auto it = faceStepIDMap.find(ExpFace.Current().TShape().get());
+			if (it != faceStepIDMap.end())
+				iShape->SetFaceStepID(ExpFace.Current(), it->second);
+		}
+	}
+}
+
+TopoDS_Shape StepReader::ExtractShard(const TopoDS_Shape& shape, Model* model) const {
+	ShapeSharder sharder(shape, m_opt->GetShardCount());
+	int shardIndex = m_opt->GetShardIndex();
+
+	ShardInfo shardInfo;
+	shardInfo.index = shardIndex;
+	shardInfo.count = sharder.GetShardCount();
+	shardInfo.solidBegin = sharder.GetSolidBegin(shardIndex);
+	shardInfo.solidEnd = sharder.GetSolidEnd(shardIndex);
+	shardInfo.solidSize = sharder.GetSolidSize();
+
+	// Every shard meshes at the deflection of the unpartitioned shape, as a single run would
+	shardInfo.deflection = OCCUtil::GetDeflection(shape);
+	model->SetShardInfo(shardInfo);
+
+	cout << "Shard " << shardIndex << "/" << shardInfo.count << ": solids " << shardInfo.solidBegin << " to " << shardInfo.solidEnd - 1 << " of " << shardInfo.solidSize << endl;
+
+	return sharder.GetShard(shardIndex);
+}
+
 bool StepReader::CheckReturnStatus(const IFSelect_ReturnStatus& status) const {
 	bool isDone = false;
 	if (status == IFSelect_RetDone) {
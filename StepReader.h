@@ -1,16 +1,34 @@
 #pragma once
 
 class Model;
+class IShape;
 
 class StepReader {
 public:
 	StepReader(InputOptions* opt);
 	~StepReader(void);
 
-	bool ReadSTEP(Model* model);
+	// False on failure or when cancelled through the progress range. Only one read runs at a time in the process.
+	bool ReadSTEP(Model* model, const Message_ProgressRange& range = Message_ProgressRange());
+
+	// Read from memory, name only labels the stream in OCCT messages
+	bool ReadSTEP(Model* model, istream& stream, const string& name, const Message_ProgressRange& range = Message_ProgressRange());
 
 protected:
+	bool ReadModel(Model* model, const function<IFSelect_ReturnStatus(STEPControl_Reader&)>& parse, const Message_ProgressRange& range);
+
+	// Transfer every root into rootShapes, null for roots that fail. With more than one transfer thread the
+	// roots are spread over work sessions that each parse their own model, sessions[rootSessions[i]] then
+	// transferred root i. Each extra session costs one more parse and one more model in memory.
+	bool TransferRoots(STEPControl_Reader& reader, const function<IFSelect_ReturnStatus(STEPControl_Reader&)>& parse, vector<TopoDS_Shape>& rootShapes,
+					   vector<STEPControl_Reader>& sessions, vector<int>& rootSessions, const Message_ProgressRange& range) const;
+	// Transfer threads that may run in this OCCT version, 1 before 7.8
+	int GetTransferThreads(void) const;
+	void AddRoot(Model* model, const TopoDS_Shape& shape, vector<IShape*>& iShapes) const;
+
 	bool CheckReturnStatus(const IFSelect_ReturnStatus& status) const;
+	void MapFaceStepIDs(const STEPControl_Reader& reader, const vector<IShape*>& iShapes) const;
+	TopoDS_Shape ExtractShard(const TopoDS_Shape& shape, Model* model) const;
 
 private:
 	InputOptions* m_opt;
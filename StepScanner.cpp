@@ -0,0 +1,509 @@
+#include "CommonImport.h"
+#include "StepScanner.h"
+#include <fstream>
+
+// Bytes read at a time
+constexpr size_t CHUNK_SIZE = 1 << 20;
+
+// Reading cost of any instance, relative to meshing one analytic face
+constexpr double READ_WEIGHT = 0.002;
+
+// Meshing cost of the instances that drive tessellation, relative to one analytic face
+static const unordered_map<string, double> MESH_WEIGHTS = {
+	{ "ADVANCED_FACE", 1.0 },
+	{ "FACE_SURFACE", 1.0 },
+	{ "B_SPLINE_SURFACE_WITH_KNOTS", 4.0 },
+	{ "RATIONAL_B_SPLINE_SURFACE", 2.0 },
+	{ "B_SPLINE_CURVE_WITH_KNOTS", 0.2 },
+	{ "TOROIDAL_SURFACE", 0.5 },
+	{ "SURFACE_OF_REVOLUTION", 1.0 },
+	{ "SURFACE_OF_LINEAR_EXTRUSION", 0.5 },
+	{ "OFFSET_SURFACE", 2.0 },
+	{ "MANIFOLD_SOLID_BREP", 2.0 },
+	{ "BREP_WITH_VOIDS", 2.0 },
+	{ "MAPPED_ITEM", 0.5 },
+	{ "NEXT_ASSEMBLY_USAGE_OCCURRENCE", 0.5 }
+};
+
+static string Trim(const string& str) {
+	size_t begin = str.find_first_not_of(" \t\r\n");
+	if (begin == string::npos)
+		return "";
+
+	size_t end = str.find_last_not_of(" \t\r\n");
+	return str.substr(begin, end - begin + 1);
+}
+
+static void AppendUtf8(string& str, uint32_t codePoint) {
+	if (codePoint < 0x80)
+		str.push_back((char)codePoint);
+	else if (codePoint < 0x800) {
+		str.push_back((char)(0xC0 | (codePoint >> 6)));
+		str.push_back((char)(0x80 | (codePoint & 0x3F)));
+	} else if (codePoint < 0x10000) {
+		str.push_back((char)(0xE0 | (codePoint >> 12)));
+		str.push_back((char)(0x80 | ((codePoint >> 6) & 0x3F)));
+		str.push_back((char)(0x80 | (codePoint & 0x3F)));
+	} else {
+		str.push_back((char)(0xF0 | (codePoint >> 18)));
+		str.push_back((char)(0x80 | ((codePoint >> 12) & 0x3F)));
+		str.push_back((char)(0x80 | ((codePoint >> 6) & 0x3F)));
+		str.push_back((char)(0x80 | (codePoint & 0x3F)));
+	}
+}
+
+// Hexadecimal digits at pos, false if there are fewer than count
+static bool ParseHex(const string& str, size_t pos, size_t count, uint32_t& value) {
+	if (pos + count > str.size())
+		return false;
+
+	value = 0;
+	for (size_t i = pos; i < pos + count; ++i) {
+		char c = str[i];
+		if (!isxdigit((unsigned char)c))
+			return false;
+
+		value = (value << 4) | (uint32_t)(isdigit((unsigned char)c) ? c - '0' : tolower(c) - 'a' + 10);
+	}
+
+	return true;
+}
+
+// Control directives of ISO 10303-21 strings to UTF-8: \\, \S\c, \X\hh, \X2\..\X0\ and \X4\..\X0\.
+// Code pages selected with \P are read as ISO 8859-1, unknown directives are kept as they are.
+static string DecodeDirectives(const string& str) {
+	string decoded;
+	size_t i = 0;
+
+	while (i < str.size()) {
+		if (str[i] != '\\') {
+			decoded.push_back(str[i++]);
+			continue;
+		}
+
+		uint32_t codePoint = 0;
+
+		if (str.compare(i, 2, "\\\\") == 0) {
+			decoded.push_back('\\');
+			i += 2;
+		} else if (str.compare(i, 3, "\\S\\") == 0
+				   && i + 3 < str.size()) {
+			AppendUtf8(decoded, (unsigned char)str[i + 3] + 0x80u);
+			i += 4;
+		} else if (str.compare(i, 3, "\\X\\") == 0
+				   && ParseHex(str, i + 3, 2, codePoint)) {
+			AppendUtf8(decoded, codePoint);
+			i += 5;
+		} else if ((str.compare(i, 4, "\\X2\\") == 0
+					|| str.compare(i, 4, "\\X4\\") == 0)
+				   && str.find("\\X0\\", i + 4) != string::npos) {
+			size_t digitCount = str[i + 2] == '2' ? 4 : 8;
+			size_t end = str.find("\\X0\\", i + 4);
+			uint32_t highSurrogate = 0;
+
+			for (size_t pos = i + 4; pos + digitCount <= end && ParseHex(str, pos, digitCount, codePoint); pos += digitCount) {
+				// UTF-16 surrogate pairs in \X2\ make one code point
+				if (codePoint >= 0xD800
+					&& codePoint < 0xDC00) {
+					highSurrogate = codePoint;
+					continue;
+				}
+
+				if (codePoint >= 0xDC00
+					&& codePoint < 0xE000) {
+					if (highSurrogate == 0)
+						continue;
+
+					codePoint = 0x10000 + ((highSurrogate - 0xD800) << 10) + (codePoint - 0xDC00);
+				}
+
+				highSurrogate = 0;
+				if (codePoint < 0x110000)
+					AppendUtf8(decoded, codePoint);
+			}
+
+			i = end + 4;
+		} else if (str.compare(i, 2, "\\P") == 0
+				   && i + 3 < str.size()
+				   && str[i + 3] == '\\') {
+			i += 4;
+		} else if (str.compare(i, 3, "\\N\\") == 0) {
+			decoded.push_back('\n');
+			i += 3;
+		} else
+			decoded.push_back(str[i++]);
+	}
+
+	return decoded;
+}
+
+StepScanner::StepScanner(void)
+	: m_byteCount(0),
+	m_entityCount(0),
+	m_header(json::object()) {}
+
+StepScanner::~StepScanner(void) {
+	Clear();
+}
+
+bool StepScanner::ScanFile(const wstring& filePath) {
+	ifstream ifs(filesystem::path(filePath), ios::binary);
+	if (!ifs.is_open()) {
+		wcout << "Cannot open STEP file: " << filePath << endl;
+		return false;
+	}
+
+	return Scan(ifs);
+}
+
+bool StepScanner::Scan(istream& is) {
+	Clear();
+
+	vector<char> buffer(CHUNK_SIZE);
+	string statement;
+	size_t equalPos = string::npos;	// Equal sign of an instance
+	bool isKept = true;			// Characters are still appended to the statement
+	bool isOpened = false;		// The first parenthesis of the statement was seen
+	bool inString = false;
+	bool inComment = false;
+	char prev = 0;
+
+	while (is.read(buffer.data(), buffer.size())
+		   || is.gcount() > 0) {
+		streamsize size = is.gcount();
+		m_byteCount += size;
+
+		for (streamsize i = 0; i < size; ++i) {
+			char c = buffer[i];
+
+			if (inComment) {
+				if (prev == '*'
+					&& c == '/') {
+					inComment = false;
+					c = 0;
+				}
+				prev = c;
+				continue;
+			}
+
+			if (!inString
+				&& prev == '/'
+				&& c == '*') {
+				inComment = true;
+				if (isKept
+					&& !statement.empty())
+					statement.pop_back();
+				prev = 0;
+				continue;
+			}
+
+			// Escaped quotes toggle twice and leave the state unchanged
+			if (c == '\'')
+				inString = !inString;
+			else if (!inString
+					 && c == ';') {
+				AddStatement(statement);
+
+				statement.clear();
+				equalPos = string::npos;
+				isKept = true;
+				isOpened = false;
+				prev = c;
+				continue;
+			}
+
+			if (isKept) {
+				statement.push_back(c);
+
+				if (!inString) {
+					if (c == '='
+						&& equalPos == string::npos
+						&& !isOpened)
+						equalPos = statement.size() - 1;
+					else if (c == '('
+							 && !isOpened) {
+						isOpened = true;
+
+						// Parameters are only needed for products and complex instances such as units
+						if (equalPos != string::npos) {
+							string type = Trim(statement.substr(equalPos + 1, statement.size() - equalPos - 2));
+							isKept = type.empty() || type == "PRODUCT";
+						}
+					}
+				}
+			}
+
+			prev = c;
+		}
+	}
+
+	return !is.bad();
+}
+
+void StepScanner::AddStatement(const string& statement) {
+	size_t begin = statement.find_first_not_of(" \t\r\n");
+	if (begin == string::npos)
+		return;
+
+	if (statement[begin] != '#') {
+		AddHeader(Trim(statement));
+		return;
+	}
+
+	size_t equalPos = statement.find('=', begin);
+	if (equalPos == string::npos)
+		return;
+
+	m_entityCount++;
+
+	size_t listBegin = statement.find_first_not_of(" \t\r\n", equalPos + 1);
+	if (listBegin != string::npos
+		&& statement[listBegin] == '(')
+		AddComplexInstance(statement, listBegin);
+	else
+		AddInstance(statement, equalPos);
+}
+
+void StepScanner::AddInstance(const string& statement, size_t equalPos) {
+	size_t open = statement.find('(', equalPos);
+	string type = Trim(statement.substr(equalPos + 1, open == string::npos ? string::npos : open - equalPos - 1));
+	m_typeCountMap[type]++;
+
+	if (type != "PRODUCT"
+		|| open == string::npos)
+		return;
+
+	size_t close = statement.rfind(')');
+	if (close == string::npos
+		|| close <= open)
+		return;
+
+	// PRODUCT(id, name, description, frame_of_reference)
+	vector<string> parameters = SplitParameters(statement.substr(open + 1, close - open - 1));
+	if (parameters.size() < 2)
+		return;
+
+	string name = DecodeString(parameters[1]);
+	m_productNames.push_back(name.empty() ? DecodeString(parameters[0]) : name);
+}
+
+void StepScanner::AddComplexInstance(const string& statement, size_t listBegin) {
+	// Partial types with their parameters, e.g. (LENGTH_UNIT() NAMED_UNIT(*) SI_UNIT(.MILLI.,.METRE.))
+	unordered_map<string, string> parts;
+	size_t pos = listBegin + 1;
+
+	while (pos < statement.size()) {
+		size_t nameBegin = statement.find_first_not_of(" \t\r\n", pos);
+		if (nameBegin == string::npos
+			|| statement[nameBegin] == ')')
+			break;
+
+		size_t open = statement.find('(', nameBegin);
+		if (open == string::npos)
+			break;
+
+		int depth = 0;
+		bool inString = false;
+		size_t close = open;
+		for (; close < statement.size(); ++close) {
+			char c = statement[close];
+
+			if (c == '\'')
+				inString = !inString;
+			else if (!inString
+					 && c == '(')
+				depth++;
+			else if (!inString
+					 && c == ')'
+					 && --depth == 0)
+				break;
+		}
+
+		string type = Trim(statement.substr(nameBegin, open - nameBegin));
+		m_typeCountMap[type]++;
+		parts[type] = statement.substr(open + 1, close - open - 1);
+
+		pos = close + 1;
+	}
+
+	if (parts.count("LENGTH_UNIT") > 0)
+		AddLengthUnit(parts);
+}
+
+void StepScanner::AddHeader(const string& statement) {
+	size_t open = statement.find('(');
+	size_t close = statement.rfind(')');
+	if (open == string::npos
+		|| close == string::npos
+		|| close <= open)
+		return;
+
+	string name = Trim(statement.substr(0, open));
+	vector<string> parameters = SplitParameters(statement.substr(open + 1, close - open - 1));
+
+	if (name == "FILE_DESCRIPTION"
+		&& parameters.size() >= 2) {
+		m_header["description"] = DecodeStringList(parameters[0]);
+		m_header["implementationLevel"] = DecodeString(parameters[1]);
+	} else if (name == "FILE_NAME"
+			   && parameters.size() >= 7) {
+		m_header["name"] = DecodeString(parameters[0]);
+		m_header["timeStamp"] = DecodeString(parameters[1]);
+		m_header["author"] = DecodeStringList(parameters[2]);
+		m_header["organization"] = DecodeStringList(parameters[3]);
+		m_header["preprocessorVersion"] = DecodeString(parameters[4]);
+		m_header["originatingSystem"] = DecodeString(parameters[5]);
+		m_header["authorization"] = DecodeString(parameters[6]);
+	} else if (name == "FILE_SCHEMA"
+			   && parameters.size() >= 1)
+		m_header["schema"] = DecodeStringList(parameters[0]);
+}
+
+void StepScanner::AddLengthUnit(const unordered_map<string, string>& parts) {
+	string unit;
+
+	auto siIt = parts.find("SI_UNIT");
+	auto conversionIt = parts.find("CONVERSION_BASED_UNIT");
+
+	if (conversionIt != parts.end()) {
+		// CONVERSION_BASED_UNIT(name, conversion_factor)
+		vector<string> parameters = SplitParameters(conversionIt->second);
+		if (!parameters.empty())
+			unit = DecodeString(parameters[0]);
+	} else if (siIt != parts.end()) {
+		// SI_UNIT(prefix, name), enumerations such as .MILLI. and .METRE.
+		for (const auto& parameter : SplitParameters(siIt->second)) {
+			if (parameter.size() > 2
+				&& parameter.front() == '.'
+				&& parameter.back() == '.')
+				unit += parameter.substr(1, parameter.size() - 2);
+		}
+	}
+
+	transform(unit.begin(), unit.end(), unit.begin(), [](char c) { return (char)tolower(c); });
+
+	if (!unit.empty()
+		&& find(m_lengthUnits.begin(), m_lengthUnits.end(), unit) == m_lengthUnits.end())
+		m_lengthUnits.push_back(unit);
+}
+
+long long StepScanner::GetTypeCount(const string& type) const {
+	auto it = m_typeCountMap.find(type);
+	return it == m_typeCountMap.end() ? 0 : it->second;
+}
+
+const double StepScanner::GetReadCost(void) const {
+	return READ_WEIGHT * m_entityCount;
+}
+
+const double StepScanner::GetMeshCost(void) const {
+	double cost = 0.0;
+	for (const auto& weight : MESH_WEIGHTS)
+		cost += weight.second * GetTypeCount(weight.first);
+
+	return cost;
+}
+
+json StepScanner::GetJson(void) const {
+	json scan = json::object();
+	scan["fileSize"] = m_byteCount;
+	scan["entityCount"] = m_entityCount;
+	scan["faceCount"] = GetFaceSize();
+	scan["solidCount"] = GetSolidSize();
+	scan["header"] = m_header;
+	scan["products"] = m_productNames;
+	scan["lengthUnits"] = m_lengthUnits;
+
+	json entityTypes = json::object();
+	for (const auto& typeCount : m_typeCountMap)
+		entityTypes[typeCount.first] = typeCount.second;
+	scan["entityTypes"] = entityTypes;
+
+	// In units of one analytic face meshed, comparable between files only
+	json cost = json::object();
+	cost["read"] = GetReadCost();
+	cost["mesh"] = GetMeshCost();
+	cost["total"] = GetCost();
+	scan["cost"] = cost;
+
+	json jsonContainer = json::object();
+	jsonContainer["scan"] = scan;
+
+	return jsonContainer;
+}
+
+vector<string> StepScanner::SplitParameters(const string& parameters) {
+	vector<string> result;
+	int depth = 0;
+	bool inString = false;
+	size_t begin = 0;
+
+	for (size_t i = 0; i < parameters.size(); ++i) {
+		char c = parameters[i];
+
+		if (c == '\'')
+			inString = !inString;
+		else if (inString)
+			continue;
+		else if (c == '(')
+			depth++;
+		else if (c == ')')
+			depth--;
+		else if (c == ','
+				 && depth == 0) {
+			result.push_back(Trim(parameters.substr(begin, i - begin)));
+			begin = i + 1;
+		}
+	}
+
+	string last = Trim(parameters.substr(begin));
+	if (!last.empty()
+		|| !result.empty())
+		result.push_back(last);
+
+	return result;
+}
+
+string StepScanner::DecodeString(const string& parameter) {
+	string str = Trim(parameter);
+	if (str.size() < 2
+		|| str.front() != '\''
+		|| str.back() != '\'')
+		return "";
+
+	// Quotes are doubled inside strings
+	string decoded;
+	for (size_t i = 1; i + 1 < str.size(); ++i) {
+		decoded.push_back(str[i]);
+
+		if (str[i] == '\''
+			&& str[i + 1] == '\'')
+			++i;
+	}
+
+	return DecodeDirectives(decoded);
+}
+
+vector<string> StepScanner::DecodeStringList(const string& parameter) {
+	vector<string> strings;
+
+	string list = Trim(parameter);
+	if (list.size() < 2
+		|| list.front() != '('
+		|| list.back() != ')')
+		return strings;
+
+	for (const auto& item : SplitParameters(list.substr(1, list.size() - 2)))
+		strings.push_back(DecodeString(item));
+
+	return strings;
+}
+
+void StepScanner::Clear(void) {
+	m_byteCount = 0;
+	m_entityCount = 0;
+	m_typeCountMap.clear();
+	m_header = json::object();
+	m_productNames.clear();
+	m_lengthUnits.clear();
+}
\ No newline at end of file
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <nlohmann/json.hpp>
+using json = nlohmann::json;
+
+// Single pass over the text of a STEP file without an entity graph: the FILE_* header, the count of each
+// entity type, product names and length units, and a rough cost of translating the file for scheduling.
+class StepScanner {
+public:
+	StepScanner(void);
+	~StepScanner(void);
+
+	bool ScanFile(const wstring& filePath);
+	bool Scan(istream& is);
+
+	json GetJson(void) const;
+
+	const long long GetEntitySize(void) const { return m_entityCount; }
+	const long long GetFaceSize(void) const { return GetTypeCount("ADVANCED_FACE") + GetTypeCount("FACE_SURFACE"); }
+	const long long GetSolidSize(void) const { return GetTypeCount("MANIFOLD_SOLID_BREP") + GetTypeCount("BREP_WITH_VOIDS"); }
+	const long long GetFileSize(void) const { return m_byteCount; }
+	const double GetReadCost(void) const;
+	const double GetMeshCost(void) const;
+	const double GetCost(void) const { return GetReadCost() + GetMeshCost(); }
+
+protected:
+	// Statements without their terminating semicolon, instances of unused types cut after their type name
+	void AddStatement(const string& statement);
+	void AddInstance(const string& statement, size_t equalPos);
+	void AddComplexInstance(const string& statement, size_t listBegin);
+	void AddHeader(const string& statement);
+	void AddLengthUnit(const unordered_map<string, string>& parts);
+
+	long long GetTypeCount(const string& type) const;
+
+	// Top level parameters of a parameter list, without the enclosing parentheses
+	static vector<string> SplitParameters(const string& parameters);
+	static string DecodeString(const string& parameter);
+	static vector<string> DecodeStringList(const string& parameter);
+
+	void Clear(void);
+
+private:
+	long long m_byteCount;
+	long long m_entityCount;
+	unordered_map<string, long long> m_typeCountMap;
+
+	json m_header;
+	vector<string> m_productNames;
+	vector<string> m_lengthUnits;
+};
\ No newline at end of file
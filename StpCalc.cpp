@@ -0,0 +1,260 @@
+#include "CommonImport.h"
+#include "StpCalc.h"
+#include "StepReader.h"
+#include "Tessellator.h"
+#include "JsonWriter.h"
+#include "Component.h"
+#include "IShape.h"
+#include "Mesh.h"
+#include "ProgressIndicator.h"
+#include "StepScanner.h"
+
+struct stpcalc_options {
+	InputOptions opt;
+	stpcalc_progress_callback callback = nullptr;
+	void* userData = nullptr;
+};
+
+struct stpcalc_result {
+	int status = STPCALC_ERROR;
+	string error;
+	string json;
+	map<string, double> metrics;
+};
+
+// Reads the caller's buffer in place instead of copying it into a string stream
+class MemoryBuffer : public streambuf {
+public:
+	MemoryBuffer(const char* data, size_t size) {
+		char* begin = const_cast<char*>(data);
+		setg(begin, begin, begin + size);
+	}
+
+protected:
+	pos_type seekoff(off_type offset, ios_base::seekdir dir, ios_base::openmode which) override {
+		char* pos = dir == ios_base::beg ? eback() : (dir == ios_base::cur ? gptr() : egptr());
+		pos += offset;
+
+		if (pos < eback()
+			|| pos > egptr())
+			return pos_type(off_type(-1));
+
+		setg(eback(), pos, egptr());
+		return pos_type(pos - eback());
+	}
+
+	pos_type seekpos(pos_type pos, ios_base::openmode which) override {
+		return seekoff(off_type(pos), ios_base::beg, which);
+	}
+};
+
+static void AddModelMetrics(Model* model, map<string, double>& metrics) {
+	vector<Component*> comps;
+	model->GetAllComponents(comps);
+
+	for (const auto& comp : comps) {
+		for (int i = 0; i < comp->GetIShapeSize(); ++i) {
+			IShape* iShape = comp->GetIShapeAt(i);
+
+			metrics["shapes"] += 1.0;
+			metrics["volume"] += iShape->GetVolume();
+			metrics["area"] += iShape->GetMassProperties().GetArea();
+			metrics["solids"] += iShape->GetSolidPropertiesSize();
+
+			if (!iShape->IsFaceSet())
+				continue;
+
+			for (int j = 0; j < iShape->GetMeshSize(); ++j) {
+				Mesh* mesh = iShape->GetMeshAt(j);
+
+				metrics["faces"] += 1.0;
+				metrics["triangles"] += mesh->GetFaceIndexSize();
+				metrics["vertices"] += mesh->GetCoordinateSize();
+
+				if (mesh->IsDegraded())
+					metrics["degraded_faces"] += 1.0;
+			}
+		}
+	}
+
+	comps.clear();
+}
+
+int stpcalc_api_version(void) {
+	return STPCALC_API_VERSION;
+}
+
+stpcalc_options* stpcalc_options_create(void) {
+	return new stpcalc_options();
+}
+
+void stpcalc_options_free(stpcalc_options* options) {
+	delete options;
+}
+
+int stpcalc_options_set(stpcalc_options* options, const char* name, const char* value) {
+	if (!options
+		|| !name
+		|| !value)
+		return STPCALC_ERROR;
+
+	string option(name);
+	if (option.compare(0, 2, "--") != 0)
+		option = "--" + option;
+
+	try {
+		return options->opt.SetOption(StrTool::s2ws(option), StrTool::s2ws(value)) ? STPCALC_OK : STPCALC_ERROR;
+	} catch (const exception&) {
+		// Numbers that do not parse
+		return STPCALC_ERROR;
+	}
+}
+
+void stpcalc_options_set_progress(stpcalc_options* options, stpcalc_progress_callback callback, void* user_data) {
+	if (!options)
+		return;
+
+	options->callback = callback;
+	options->userData = user_data;
+}
+
+stpcalc_result* stpcalc_run(const void* data, size_t size, const stpcalc_options* options) {
+	stpcalc_result* result = new stpcalc_result();
+
+	if (!data) {
+		result->error = "No STEP data";
+		return result;
+	}
+
+	InputOptions opt = options ? options->opt : InputOptions();
+
+	// The raw pointer keeps the callback from owning its indicator
+	Handle(ProgressIndicator) progress = new ProgressIndicator();
+	ProgressIndicator* indicator = progress.get();
+	if (options
+		&& options->callback) {
+		progress->SetCallback([options, indicator](const string& stage, double fraction) {
+			if (options->callback(stage.c_str(), fraction, options->userData) != 0)
+				indicator->Cancel();
+		});
+	}
+
+	Message_ProgressScope scope(progress->Start(), "STEP to JSON", 10);
+	Model* model = new Model();
+
+	try {
+		MemoryBuffer buffer((const char*)data, size);
+		istream stream(&buffer);
+
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		StepReader sr(&opt);
+		bool isDone = sr.ReadSTEP(model, stream, "stpcalc_run", scope.Next(3));
+		result->metrics["read_seconds"] = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+		if (isDone) {
+			start = chrono::steady_clock::now();
+			Tessellator ts(&opt);
+			isDone = ts.Tessellate(model, scope.Next(6));
+			result->metrics["tessellate_seconds"] = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+		}
+
+		if (isDone) {
+			start = chrono::steady_clock::now();
+			JsonWriter jw(&opt);
+			isDone = jw.SerializeJson(model, result->json, scope.Next(1));
+			result->metrics["write_seconds"] = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+		}
+
+		if (isDone) {
+			AddModelMetrics(model, result->metrics);
+			result->status = STPCALC_OK;
+		} else if (progress->IsCancelled()) {
+			result->status = STPCALC_CANCELLED;
+			result->error = "Cancelled";
+		} else
+			result->error = "Reading the STEP data has failed";
+	} catch (const Standard_Failure& failure) {
+		result->error = failure.GetMessageString();
+	} catch (const exception& e) {
+		result->error = e.what();
+	} catch (...) {
+		// Nothing may cross the C interface
+		result->error = "Unknown failure";
+	}
+
+	if (result->status != STPCALC_OK)
+		result->json.clear();
+
+	delete model;
+
+	return result;
+}
+
+stpcalc_result* stpcalc_scan(const void* data, size_t size) {
+	stpcalc_result* result = new stpcalc_result();
+
+	if (!data) {
+		result->error = "No STEP data";
+		return result;
+	}
+
+	try {
+		MemoryBuffer buffer((const char*)data, size);
+		istream stream(&buffer);
+
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		StepScanner sc;
+		if (!sc.Scan(stream)) {
+			result->error = "Scanning the STEP data has failed";
+			return result;
+		}
+
+		result->json = sc.GetJson().dump(-1, ' ', false, json::error_handler_t::replace);
+		result->metrics["entities"] = (double)sc.GetEntitySize();
+		result->metrics["faces"] = (double)sc.GetFaceSize();
+		result->metrics["solids"] = (double)sc.GetSolidSize();
+		result->metrics["cost"] = sc.GetCost();
+		result->metrics["scan_seconds"] = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+		result->status = STPCALC_OK;
+	} catch (const exception& e) {
+		result->error = e.what();
+	} catch (...) {
+		result->error = "Unknown failure";
+	}
+
+	if (result->status != STPCALC_OK)
+		result->json.clear();
+
+	return result;
+}
+
+int stpcalc_result_status(const stpcalc_result* result) {
+	return result ? result->status : STPCALC_ERROR;
+}
+
+const char* stpcalc_result_error(const stpcalc_result* result) {
+	return result ? result->error.c_str() : "";
+}
+
+const char* stpcalc_result_json(const stpcalc_result* result, size_t* size) {
+	if (size)
+		*size = result ? result->json.size() : 0;
+
+	return result ? result->json.c_str() : "";
+}
+
+double stpcalc_result_metric(const stpcalc_result* result, const char* name) {
+	if (!result
+		|| !name)
+		return 0.0;
+
+	auto it = result->metrics.find(name);
+	if (it == result->metrics.end())
+		return 0.0;
+
+	return it->second;
+}
+
+void stpcalc_result_free(stpcalc_result* result) {
+	delete result;
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+#pragma once
+
+// C interface of the stpcalc library: translate a STEP file held in memory and get the JSON document
+// STPCalculator would write, with a few metrics, without a process or a file in between.
+// Separate runs may go on different threads, but their read stages take turns: OCCT keeps process-wide
+// state while reading STEP data. Tessellating and writing still run side by side.
+
+#include <stddef.h>
+
+#if defined(_WIN32) && defined(STPCALC_DLL)
+#ifdef STPCALC_EXPORTS
+#define STPCALC_API __declspec(dllexport)
+#else
+#define STPCALC_API __declspec(dllimport)
+#endif
+#else
+#define STPCALC_API
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Bumped on incompatible changes only
+#define STPCALC_API_VERSION 1
+
+// Status of a run
+#define STPCALC_OK 0
+#define STPCALC_ERROR -1
+#define STPCALC_CANCELLED -2
+
+typedef struct stpcalc_options stpcalc_options;
+typedef struct stpcalc_result stpcalc_result;
+
+// Called with the stage name and the fraction of the run done, a non-zero return cancels the run
+typedef int (*stpcalc_progress_callback)(const char* stage, double fraction, void* user_data);
+
+STPCALC_API int stpcalc_api_version(void);
+
+STPCALC_API stpcalc_options* stpcalc_options_create(void);
+STPCALC_API void stpcalc_options_free(stpcalc_options* options);
+
+// Options of the command line, with or without the leading dashes, e.g. ("normals", "on"). 0 on success.
+STPCALC_API int stpcalc_options_set(stpcalc_options* options, const char* name, const char* value);
+STPCALC_API void stpcalc_options_set_progress(stpcalc_options* options, stpcalc_progress_callback callback, void* user_data);
+
+// Translate size bytes of STEP data, options may be NULL. Never returns NULL; release with stpcalc_result_free.
+STPCALC_API stpcalc_result* stpcalc_run(const void* data, size_t size, const stpcalc_options* options);
+
+// Scan size bytes of STEP text for the header, entity counts and cost estimate without translating it.
+// The JSON holds a "scan" object; metrics are "entities", "faces", "solids", "cost" and "scan_seconds".
+STPCALC_API stpcalc_result* stpcalc_scan(const void* data, size_t size);
+
+STPCALC_API int stpcalc_result_status(const stpcalc_result* result);
+STPCALC_API const char* stpcalc_result_error(const stpcalc_result* result);
+
+// JSON document owned by the result, empty unless the status is STPCALC_OK
+STPCALC_API const char* stpcalc_result_json(const stpcalc_result* result, size_t* size);
+
+// Metric by name, 0 if unknown: "shapes", "solids", "faces", "triangles", "vertices", "volume", "area",
+// "degraded_faces", "read_seconds", "tessellate_seconds" and "write_seconds"
+STPCALC_API double stpcalc_result_metric(const stpcalc_result* result, const char* name);
+
+STPCALC_API void stpcalc_result_free(stpcalc_result* result);
+
+#ifdef __cplusplus
+}
+#endif
\ No newline at end of file
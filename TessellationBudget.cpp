@@ -0,0 +1,264 @@
+#include "CommonImport.h"
+#include "TessellationBudget.h"
+
+// Deflection growth of one coarsening round, about a quarter of the triangles on curved faces
+constexpr double COARSEN_FACTOR = 4.0;
+constexpr int MAX_COARSEN_ROUNDS = 3;
+constexpr double MAX_ANGULAR_DEFLECTION = 1.0;
+
+// Share of the model time limit allowed past the deadline for the faces left unmeshed
+constexpr double OVERTIME_FRACTION = 0.25;
+
+Standard_Boolean DeadlineIndicator::UserBreak(void) {
+	return chrono::steady_clock::now() > m_deadline
+		|| (m_budget && m_budget->IsCancelled());
+}
+
+TessellationBudget::TessellationBudget(InputOptions* opt)
+	: m_maxTriangles(opt->GetMaxTriangles()),
+	m_maxFaceTriangles(opt->GetMaxFaceTriangles()),
+	m_timeLimit(opt->GetTimeLimit()),
+	m_faceTimeLimit(opt->GetFaceTimeLimit()),
+	m_parentScope(nullptr),
+	m_triangleCount(0),
+	m_failedFaceCount(0),
+	m_skippedFaceCount(0),
+	m_isTimedOut(false) {}
+
+TessellationBudget::~TessellationBudget(void) {
+	Clear();
+}
+
+void TessellationBudget::Start(const Message_ProgressScope* parentScope) {
+	m_triangleCount = 0;
+	m_failedFaceCount = 0;
+	m_skippedFaceCount = 0;
+	m_isTimedOut = false;
+	m_degradedFaces.clear();
+	m_parentScope = parentScope;
+	m_modelIndicator.Nullify();
+
+	if (m_timeLimit <= 0.0
+		&& !m_parentScope)
+		return;
+
+	if (m_timeLimit > 0.0) {
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		m_deadline = start + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(m_timeLimit));
+		m_overtimeEnd = start + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(m_timeLimit * (1.0 + OVERTIME_FRACTION)));
+	} else {
+		m_deadline = chrono::steady_clock::time_point::max();
+		m_overtimeEnd = chrono::steady_clock::time_point::max();
+	}
+	m_modelIndicator = new DeadlineIndicator(m_deadline, this);
+}
+
+void TessellationBudget::Finish(void) {
+	m_parentScope = nullptr;
+}
+
+Message_ProgressRange TessellationBudget::GetModelRange(void) const {
+	if (m_modelIndicator.IsNull())
+		return Message_ProgressRange();
+
+	return m_modelIndicator->Start();
+}
+
+bool TessellationBudget::IsModelTimeOver(void) const {
+	return m_timeLimit > 0.0
+		&& !m_modelIndicator.IsNull()
+		&& chrono::steady_clock::now() > m_deadline;
+}
+
+bool TessellationBudget::IsCancelled(void) const {
+	return m_parentScope
+		&& m_parentScope->UserBreak();
+}
+
+bool TessellationBudget::IsOvertimeOver(void) const {
+	return m_timeLimit > 0.0
+		&& chrono::steady_clock::now() > m_overtimeEnd;
+}
+
+bool TessellationBudget::MeshFace(const TopoDS_Face& face, const IMeshTools_Parameters& parameters) const {
+	chrono::steady_clock::time_point deadline = m_faceTimeLimit > 0.0
+		? chrono::steady_clock::now() + chrono::duration_cast<chrono::steady_clock::duration>(chrono::duration<double>(m_faceTimeLimit))
+		: chrono::steady_clock::time_point::max();
+
+	return MeshFace(face, parameters, deadline);
+}
+
+bool TessellationBudget::MeshFace(const TopoDS_Face& face, const IMeshTools_Parameters& parameters, const chrono::steady_clock::time_point& deadline) const {
+	if (deadline == chrono::steady_clock::time_point::max()
+		&& !m_parentScope) {
+		BRepMesh_IncrementalMesh bMesh(face, parameters);
+		return bMesh.IsDone();
+	}
+
+	Handle(Message_ProgressIndicator) indicator = new DeadlineIndicator(deadline, this);
+
+	BRepMesh_IncrementalMesh bMesh(face, parameters, indicator->Start());
+	return bMesh.IsDone()
+		&& !indicator->UserBreak();
+}
+
+void TessellationBudget::Enforce(const TopoDS_Shape& shape, const IMeshTools_Parameters& parameters) {
+	// Faces left unmeshed by the timeout are coarsened below, past the deadline
+	if (IsModelTimeOver())
+		m_isTimedOut = true;
+
+	// Located instances share one triangulation, so every face is checked once
+	unordered_set<const TopoDS_TShape*> visited;
+	vector<pair<int, TopoDS_Face>> meshedFaces;
+	vector<TopoDS_Face> overFaces;
+
+	int shapeTriangleCount = 0;
+	TopExp_Explorer ExpFace;
+	for (ExpFace.Init(shape, TopAbs_FACE); ExpFace.More(); ExpFace.Next()) {
+		const TopoDS_Face& face = TopoDS::Face(ExpFace.Current());
+
+		if (!visited.insert(face.TShape().get()).second)
+			continue;
+
+		int triangleCount = CountTriangles(face);
+		if (triangleCount < 0
+			|| (m_maxFaceTriangles > 0 && triangleCount > m_maxFaceTriangles)) {
+			overFaces.push_back(face);
+			continue;
+		}
+
+		meshedFaces.push_back(make_pair(triangleCount, face));
+		shapeTriangleCount += triangleCount;
+	}
+
+	// Unmeshed faces, after a timeout or a failure, and faces over the face limit
+	for (const auto& face : overFaces) {
+		if (IsCancelled())
+			return;
+
+		// Past the overtime the remaining faces stay unmeshed
+		if (IsOvertimeOver()) {
+			m_skippedFaceCount++;
+			m_degradedFaces.insert(face.TShape().get());
+			continue;
+		}
+
+		Coarsen(face, parameters, m_maxFaceTriangles > 0 ? m_maxFaceTriangles : INT_MAX);
+	}
+
+	// Over the model limit the heaviest faces are coarsened first
+	if (m_maxTriangles > 0) {
+		sort(meshedFaces.begin(), meshedFaces.end(), [](const pair<int, TopoDS_Face>& a, const pair<int, TopoDS_Face>& b) {
+			return a.first > b.first;
+		});
+
+		int excess = m_triangleCount + shapeTriangleCount - m_maxTriangles;
+		for (const auto& meshedFace : meshedFaces) {
+			if (excess <= 0
+				|| IsCancelled()
+				|| IsOvertimeOver())
+				break;
+
+			Coarsen(meshedFace.second, parameters, max(meshedFace.first / 2, 1));
+			excess -= meshedFace.first - max(CountTriangles(meshedFace.second), 0);
+		}
+	}
+
+	visited.clear();
+	for (ExpFace.Init(shape, TopAbs_FACE); ExpFace.More(); ExpFace.Next()) {
+		const TopoDS_Face& face = TopoDS::Face(ExpFace.Current());
+
+		if (visited.insert(face.TShape().get()).second)
+			m_triangleCount += max(CountTriangles(face), 0);
+	}
+}
+
+bool TessellationBudget::Coarsen(const TopoDS_Face& face, const IMeshTools_Parameters& parameters, int maxTriangleCount) {
+	IMeshTools_Parameters coarseParameters = parameters;
+	coarseParameters.Relative = false;
+	coarseParameters.InParallel = false;
+
+	// Start from the deflection the face was meshed with, or from its own box if it has none
+	TopLoc_Location loc;
+	const Handle(Poly_Triangulation)& triangulation = BRep_Tool::Triangulation(face, loc);
+	double deflection = !triangulation.IsNull() && triangulation->Deflection() > 0.0
+		? triangulation->Deflection()
+		: OCCUtil::GetDeflection(face);
+
+	// Past the deadline a face gets a single pass at the coarsest deflection, bounded by the overtime
+	bool isOvertime = IsModelTimeOver();
+	int roundCount = isOvertime ? 1 : MAX_COARSEN_ROUNDS;
+	if (isOvertime) {
+		deflection *= pow(COARSEN_FACTOR, MAX_COARSEN_ROUNDS - 1);
+		coarseParameters.Angle = Min(coarseParameters.Angle * pow(2.0, MAX_COARSEN_ROUNDS - 1), MAX_ANGULAR_DEFLECTION);
+	}
+
+	int triangleCount = -1;
+	for (int round = 0; round < roundCount; ++round) {
+		deflection *= COARSEN_FACTOR;
+		coarseParameters.Deflection = deflection;
+		coarseParameters.Angle = Min(coarseParameters.Angle * 2.0, MAX_ANGULAR_DEFLECTION);
+
+		// Only the face triangulation is dropped, the edges keep the polygons shared with the neighbours
+		BRep_Builder builder;
+		builder.UpdateFace(face, Handle(Poly_Triangulation)());
+
+		if (isOvertime)
+			MeshFace(face, coarseParameters, m_overtimeEnd);
+		else
+			MeshFace(face, coarseParameters);
+
+		triangleCount = CountTriangles(face);
+		if (triangleCount >= 0
+			&& triangleCount <= maxTriangleCount)
+			break;
+	}
+
+	m_degradedFaces.insert(face.TShape().get());
+
+	if (triangleCount < 0) {
+		m_failedFaceCount++;
+		return false;
+	}
+
+	return true;
+}
+
+bool TessellationBudget::IsDegraded(const TopoDS_Face& face) const {
+	return m_degradedFaces.find(face.TShape().get()) != m_degradedFaces.end();
+}
+
+int TessellationBudget::CountTriangles(const TopoDS_Face& face) {
+	TopLoc_Location loc;
+	const Handle(Poly_Triangulation)& triangulation = BRep_Tool::Triangulation(face, loc);
+
+	if (triangulation.IsNull())
+		return -1;
+
+	return triangulation->NbTriangles();
+}
+
+void TessellationBudget::Print(void) const {
+	cout << "Tessellation budget" << endl;
+	cout << "\tTriangles: " << m_triangleCount;
+	if (m_maxTriangles > 0)
+		cout << " (limit " << m_maxTriangles << ")";
+	cout << endl;
+
+	if (m_isTimedOut)
+		cout << "\tModel time limit of " << m_timeLimit << " s exceeded" << endl;
+
+	cout << "\tDegraded faces: " << m_degradedFaces.size() << endl;
+
+	if (m_failedFaceCount > 0)
+		cout << "\tUnmeshed faces: " << m_failedFaceCount << endl;
+
+	if (m_skippedFaceCount > 0)
+		cout << "\tFaces left unmeshed after the overtime: " << m_skippedFaceCount << endl;
+}
+
+void TessellationBudget::Clear(void) {
+	m_parentScope = nullptr;
+	m_modelIndicator.Nullify();
+	m_degradedFaces.clear();
+}
\ No newline at end of file
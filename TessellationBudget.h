@@ -0,0 +1,73 @@
+#pragma once
+
+class TessellationBudget;
+
+// Breaks BRepMesh once its deadline has passed or the tessellation of its budget is cancelled
+class DeadlineIndicator : public Message_ProgressIndicator {
+public:
+	DeadlineIndicator(const chrono::steady_clock::time_point& deadline, const TessellationBudget* budget)
+		: m_deadline(deadline), m_budget(budget) {}
+
+	Standard_Boolean UserBreak(void) override;
+	void Show(const Message_ProgressScope&, const Standard_Boolean) override {}
+
+private:
+	chrono::steady_clock::time_point m_deadline;
+	const TessellationBudget* m_budget;	// Owns or outlives the indicator
+};
+
+// Triangle and wall-clock limits of a tessellation; faces over a limit fall back to a coarser deflection
+class TessellationBudget {
+public:
+	TessellationBudget(InputOptions* opt);
+	~TessellationBudget(void);
+
+	// Start the model clock, ranges handed out afterwards break at the model time limit.
+	// Cancelling parentScope breaks them too, until Finish is called before the scope ends.
+	void Start(const Message_ProgressScope* parentScope = nullptr);
+	void Finish(void);
+	Message_ProgressRange GetModelRange(void) const;
+	bool IsModelTimeOver(void) const;
+	bool IsCancelled(void) const;
+
+	// Mesh a single face within the face time limit
+	bool MeshFace(const TopoDS_Face& face, const IMeshTools_Parameters& parameters) const;
+
+	// Coarsen the faces of a meshed shape that are unmeshed or over a triangle limit
+	void Enforce(const TopoDS_Shape& shape, const IMeshTools_Parameters& parameters);
+
+	bool IsDegraded(const TopoDS_Face& face) const;
+	const int GetDegradedFaceSize(void) const { return (int)m_degradedFaces.size(); }
+
+	void Print(void) const;
+
+	static int CountTriangles(const TopoDS_Face& face);
+
+protected:
+	bool Coarsen(const TopoDS_Face& face, const IMeshTools_Parameters& parameters, int maxTriangleCount);
+
+	// Mesh a face once, broken at the deadline
+	bool MeshFace(const TopoDS_Face& face, const IMeshTools_Parameters& parameters, const chrono::steady_clock::time_point& deadline) const;
+
+	// Past the model deadline, faces are only meshed until the overtime ends
+	bool IsOvertimeOver(void) const;
+
+	void Clear(void);
+
+private:
+	int m_maxTriangles;			// Triangles of the model, 0 = no limit
+	int m_maxFaceTriangles;		// Triangles of a face, 0 = no limit
+	double m_timeLimit;			// Seconds of meshing for the model, 0 = no limit
+	double m_faceTimeLimit;		// Seconds of meshing for a face, 0 = no limit
+
+	const Message_ProgressScope* m_parentScope;
+	Handle(Message_ProgressIndicator) m_modelIndicator;
+	chrono::steady_clock::time_point m_deadline;
+	chrono::steady_clock::time_point m_overtimeEnd;	// End of the coarse meshing allowed past the deadline
+
+	int m_triangleCount;		// Triangles of the shapes enforced so far
+	int m_failedFaceCount;		// Faces left unmeshed even at the coarsest deflection
+	int m_skippedFaceCount;		// Faces left unmeshed once the overtime was over
+	bool m_isTimedOut;			// Meshing was broken at the model time limit
+	unordered_set<const TopoDS_TShape*> m_degradedFaces;
+};
\ No newline at end of file
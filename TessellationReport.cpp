@@ -0,0 +1,176 @@
+#include "CommonImport.h"
+#include "TessellationReport.h"
+#include <iomanip>
+
+// Decade buckets used by both histograms
+constexpr int HISTOGRAM_BUCKET_SIZE = 6;
+
+TessellationReport::TessellationReport(void) {}
+
+TessellationReport::~TessellationReport(void) {
+	Clear();
+}
+
+FaceCost& TessellationReport::GetFaceCost(const TopoDS_Face& face) {
+	// Faces are keyed by their TShape so located instances share one entry
+	const TopoDS_TShape* tShape = face.TShape().get();
+
+	auto it = m_faceCostIndexMap.find(tShape);
+	if (it != m_faceCostIndexMap.end())
+		return m_faceCosts[it->second];
+
+	FaceCost faceCost;
+	faceCost.faceIndex = (int)m_faceCosts.size();
+	faceCost.surfaceType = BRepAdaptor_Surface(face, false).GetType();
+
+	m_faceCostIndexMap.insert({ tShape, faceCost.faceIndex });
+	m_faceCosts.push_back(faceCost);
+
+	return m_faceCosts.back();
+}
+
+void TessellationReport::AddMeshTime(const TopoDS_Face& face, double meshTime) {
+	FaceCost& faceCost = GetFaceCost(face);
+	faceCost.meshTime += meshTime;
+}
+
+void TessellationReport::AddFace(const TopoDS_Face& face, int stepID, double extractTime, int triangleCount, int nodeCount) {
+	FaceCost& faceCost = GetFaceCost(face);
+	faceCost.stepID = stepID;
+	faceCost.extractTime += extractTime;
+	faceCost.triangleCount += triangleCount;
+	faceCost.nodeCount += nodeCount;
+}
+
+void TessellationReport::Print(int topCount) const {
+	if (m_faceCosts.empty())
+		return;
+
+	cout << "Tessellation report: " << m_faceCosts.size() << " faces" << endl;
+
+	PrintTimeHistogram();
+	PrintTriangleHistogram();
+	PrintWorstFaces(topCount, true);
+	PrintWorstFaces(topCount, false);
+
+	cout << endl;
+}
+
+void TessellationReport::PrintTimeHistogram(void) const {
+	const string labels[HISTOGRAM_BUCKET_SIZE] = { "< 0.1 ms", "< 1 ms", "< 10 ms", "< 100 ms", "< 1 s", ">= 1 s" };
+	int counts[HISTOGRAM_BUCKET_SIZE] = { 0 };
+	double times[HISTOGRAM_BUCKET_SIZE] = { 0.0 };
+	double totalTime = 0.0;
+
+	for (const auto& faceCost : m_faceCosts) {
+		double time = faceCost.GetTotalTime();
+		int bucket = 0;
+
+		// 0.1 ms, 1 ms, 10 ms.. upper bounds
+		for (double bound = 1.e-4; bucket < HISTOGRAM_BUCKET_SIZE - 1 && time >= bound; bound *= 10.0)
+			bucket++;
+
+		counts[bucket]++;
+		times[bucket] += time;
+		totalTime += time;
+	}
+
+	cout << "\tFace time histogram (faces, share of time)" << endl;
+
+	for (int i = 0; i < HISTOGRAM_BUCKET_SIZE; ++i) {
+		double share = totalTime > 0.0 ? times[i] / totalTime : 0.0;
+
+		cout << "\t" << setw(10) << labels[i] << " " << setw(8) << counts[i] << " " << setw(6) << fixed << setprecision(1) << share * 100.0 << "% ";
+		cout << string((int)(share * 40.0 + 0.5), '#') << endl;
+	}
+
+	cout.unsetf(ios::fixed);
+	cout << setprecision(6);
+}
+
+void TessellationReport::PrintTriangleHistogram(void) const {
+	const string labels[HISTOGRAM_BUCKET_SIZE] = { "< 10", "< 100", "< 1k", "< 10k", "< 100k", ">= 100k" };
+	int counts[HISTOGRAM_BUCKET_SIZE] = { 0 };
+	int maxCount = 0;
+
+	for (const auto& faceCost : m_faceCosts) {
+		int bucket = 0;
+
+		for (int bound = 10; bucket < HISTOGRAM_BUCKET_SIZE - 1 && faceCost.triangleCount >= bound; bound *= 10)
+			bucket++;
+
+		counts[bucket]++;
+		maxCount = max(maxCount, counts[bucket]);
+	}
+
+	cout << "\tFace triangle histogram (faces)" << endl;
+
+	for (int i = 0; i < HISTOGRAM_BUCKET_SIZE; ++i) {
+		int barSize = maxCount > 0 ? (int)(counts[i] * 40.0 / maxCount + 0.5) : 0;
+
+		cout << "\t" << setw(10) << labels[i] << " " << setw(8) << counts[i] << " " << string(barSize, '#') << endl;
+	}
+}
+
+void TessellationReport::PrintWorstFaces(int topCount, bool byTime) const {
+	vector<const FaceCost*> faceCosts;
+	for (const auto& faceCost : m_faceCosts)
+		faceCosts.push_back(&faceCost);
+
+	int size = min(topCount, (int)faceCosts.size());
+
+	partial_sort(faceCosts.begin(), faceCosts.begin() + size, faceCosts.end(), [byTime](const FaceCost* a, const FaceCost* b) {
+		if (byTime)
+			return a->GetTotalTime() > b->GetTotalTime();
+
+		return a->triangleCount > b->triangleCount;
+	});
+
+	if (byTime)
+		cout << "\tTop " << size << " faces by time" << endl;
+	else
+		cout << "\tTop " << size << " faces by triangles" << endl;
+
+	cout << "\t" << setw(8) << "face" << setw(10) << "step id" << setw(16) << "surface" << setw(12) << "mesh ms" << setw(12) << "extract ms" << setw(12) << "triangles" << setw(10) << "nodes" << endl;
+
+	for (int i = 0; i < size; ++i) {
+		const FaceCost* faceCost = faceCosts[i];
+		string stepID = faceCost->stepID != -1 ? "#" + to_string(faceCost->stepID) : "-";
+
+		cout << "\t" << setw(8) << faceCost->faceIndex << setw(10) << stepID << setw(16) << GetSurfaceTypeName(faceCost->surfaceType);
+		cout << setw(12) << faceCost->meshTime * 1.e3 << setw(12) << faceCost->extractTime * 1.e3;
+		cout << setw(12) << faceCost->triangleCount << setw(10) << faceCost->nodeCount << endl;
+	}
+}
+
+const string TessellationReport::GetSurfaceTypeName(GeomAbs_SurfaceType surfaceType) {
+	switch (surfaceType) {
+	case GeomAbs_Plane:
+		return "Plane";
+	case GeomAbs_Cylinder:
+		return "Cylinder";
+	case GeomAbs_Cone:
+		return "Cone";
+	case GeomAbs_Sphere:
+		return "Sphere";
+	case GeomAbs_Torus:
+		return "Torus";
+	case GeomAbs_BezierSurface:
+		return "Bezier";
+	case GeomAbs_BSplineSurface:
+		return "BSpline";
+	case GeomAbs_SurfaceOfRevolution:
+		return "Revolution";
+	case GeomAbs_SurfaceOfExtrusion:
+		return "Extrusion";
+	case GeomAbs_OffsetSurface:
+		return "Offset";
+	default:
+		return "Other";
+	}
+}
+
+void TessellationReport::Clear(void) {
+	m_faceCosts.clear();
+	m_faceCostIndexMap.clear();
+}
\ No newline at end of file
@@ -0,0 +1,44 @@
+#pragma once
+
+// Tessellation cost of a single face
+struct FaceCost {
+	int faceIndex = 0;			// Order of the face in the IShape
+	int stepID = -1;			// STEP entity number of the ADVANCED_FACE, -1 if unknown
+	GeomAbs_SurfaceType surfaceType = GeomAbs_OtherSurface;
+	double meshTime = 0.0;		// BRepMesh time in seconds
+	double extractTime = 0.0;	// GetMeshForFace time in seconds
+	int triangleCount = 0;
+	int nodeCount = 0;
+
+	double GetTotalTime(void) const { return meshTime + extractTime; }
+};
+
+class TessellationReport {
+public:
+	TessellationReport(void);
+	~TessellationReport(void);
+
+	void AddMeshTime(const TopoDS_Face& face, double meshTime);
+	void AddFace(const TopoDS_Face& face, int stepID, double extractTime, int triangleCount, int nodeCount);
+
+	const int GetFaceCostSize(void) const { return (int)m_faceCosts.size(); }
+	const FaceCost& GetFaceCostAt(int index) const { return m_faceCosts[index]; }
+
+	// Print histograms and the topCount worst faces
+	void Print(int topCount) const;
+
+	static const string GetSurfaceTypeName(GeomAbs_SurfaceType surfaceType);
+
+protected:
+	FaceCost& GetFaceCost(const TopoDS_Face& face);
+
+	void PrintTimeHistogram(void) const;
+	void PrintTriangleHistogram(void) const;
+	void PrintWorstFaces(int topCount, bool byTime) const;
+
+	void Clear(void);
+
+private:
+	vector<FaceCost> m_faceCosts;
+	unordered_map<const TopoDS_TShape*, int> m_faceCostIndexMap;
+};
\ No newline at end of file
@@ -3,9 +3,29 @@
 #include "Component.h"
 #include "IShape.h"
 #include "Mesh.h"
+#include "TessellationReport.h"
+#include "TessellationBudget.h"
+#include "MeshOptimizer.h"
+#include "MeshDecimator.h"
+#include "MeshCache.h"
+#include "ShapeFingerprint.h"
+
+// Relative deflection of the first adaptive pass, the ratio Prs3d::GetDeflection applies to the root box
+constexpr double ADAPTIVE_DEFLECTION = 0.004;
+constexpr double MIN_ADAPTIVE_DEFLECTION = 0.0001;
+constexpr double MAX_ADAPTIVE_DEFLECTION = 0.2;
+
+// Smallest element of a solid relative to its deflection, keeps tiny features from being overmeshed
+constexpr double MIN_SIZE_RATIO = 0.01;
+
+// Meshing passes spent on reaching the triangle budget
+constexpr int MAX_BUDGET_PASSES = 4;
 
 Tessellator::Tessellator(InputOptions* opt)
-	: m_opt(opt) {
+	: m_opt(opt),
+	m_report(nullptr),
+	m_budget(nullptr),
+	m_cache(nullptr) {
 	double angDeflection_max = 0.8, angDeflection_min = 0.2, angDeflection_gap = (angDeflection_max - angDeflection_min) / 10;
 	m_angDeflection = max(angDeflection_max - (m_opt->GetQuality() * angDeflection_gap), angDeflection_min);
 
@@ -13,82 +33,540 @@ Tessellator::Tessellator(InputOptions* opt)
 	//m_angDeflection = 5.0 / m_opt->Quality();
 
 	m_isRelative = false; // If TRUE, linear deflection is automatically set.
+
+	if (m_opt->GetFaceReport() > 0)
+		m_report = new TessellationReport();
+
+	if (m_opt->HasTessellationLimit())
+		m_budget = new TessellationBudget(m_opt);
+
+	// Budgets and limits depend on every solid of the model, a cached solid alone cannot reproduce them
+	if (!m_opt->GetMeshCache().empty()) {
+		if (m_budget
+			|| m_opt->GetTriangleBudget() > 0)
+			cout << "Mesh cache is not used with triangle budgets or tessellation limits" << endl;
+		else
+			m_cache = new MeshCache(m_opt->GetMeshCache(), m_opt->GetMassTolerance());
+	}
+}
+
+Tessellator::~Tessellator(void) {
+	delete m_report;
+	delete m_budget;
+	delete m_cache;
 }
 
-Tessellator::~Tessellator(void) {}
+bool Tessellator::Tessellate(Model*& model, const Message_ProgressRange& range) const {
+	bool isTessellated = TessellateModel(model, range);
 
-void Tessellator::Tessellate(Model*& model) const {
-	TessellateModel(model);
+	// The scope the budget watched for cancellation ended with TessellateModel
+	if (m_budget)
+		m_budget->Finish();
+
+	if (!isTessellated) {
+		cout << "Tessellation cancelled" << endl;
+		return false;
+	}
 
 	model->Update();
+
+	// Written boxes are taken after meshing: BRepBndLib then bounds the triangulations, which is tighter
+	// than the B-rep box used for the deflection, or the mesh nodes themselves with --bounds mesh
+	model->ComputeBoundingBoxes(m_opt->GetMeshBounds());
+
+	// Stock sizes written next to the bounding boxes
+	model->ComputeOrientedBoundingBoxes();
+
+	if (m_report)
+		m_report->Print(m_opt->GetFaceReport());
+
+	if (m_budget)
+		m_budget->Print();
+
+	if (m_cache)
+		m_cache->Print();
+
+	return true;
 }
 
-void Tessellator::TessellateModel(Model*& model) const {
-	for (int i = 0; i < model->GetComponentSize(); ++i) {
-		Component* rootComp = model->GetComponentAt(i);
-		const TopoDS_Shape& shape = rootComp->GetShape();
+bool Tessellator::TessellateModel(Model*& model, const Message_ProgressRange& range) const {
+	// Meshing dominates, the steps are weighted accordingly
+	Message_ProgressScope scope(range, "Tessellating", 10);
 
-		// Get the relative linear deflection for a shape
-		double linDeflection = OCCUtil::GetDeflection(shape);
+	// B-rep boxes for the deflection, computed again for the writers once meshed
+	model->ComputeBoundingBoxes(false);
 
-		// Tessellate and add mesh data of a shape
-		if (!OCCUtil::TessellateShape(shape, linDeflection, m_isRelative, m_angDeflection, true))
-			wcout << "\tTessellation has failed on Shape: " << rootComp->GetName() << endl;
+	if (m_budget)
+		m_budget->Start(&scope);
+
+	if (m_cache)
+		LoadCachedSolids(model);
+
+	if (m_opt->GetAdaptiveDeflection())
+		TessellateAdaptive(model, scope.Next(6));
+	else
+		TessellateGlobal(model, scope.Next(6));
+
+	if (scope.UserBreak())
+		return false;
+
+	// Faces over a limit, or left unmeshed at the deadline, are meshed again at a coarser deflection
+	if (m_budget) {
+		Message_ProgressScope budgetScope(scope.Next(), "Enforcing budget", model->GetComponentSize());
+		TraceScope budgetTrace("EnforceBudget", "mesh");
+
+		for (int i = 0; i < model->GetComponentSize() && budgetScope.More(); ++i, budgetScope.Next()) {
+			Component* rootComp = model->GetComponentAt(i);
+			double linDeflection = GetRootDeflection(model, rootComp);
+
+			m_budget->Enforce(rootComp->GetShape(), GetParameters(linDeflection, false));
+		}
 	}
 
 	vector<Component*> comps;
 	model->GetAllComponents(comps);
 
+	Message_ProgressScope extractScope(scope.Next(2), "Extracting meshes", (double)comps.size());
 	for (const auto& comp : comps) {
+		if (!extractScope.More())
+			return false;
+
 		for (int i = 0; i < comp->GetIShapeSize(); ++i) {
 			IShape* iShape = comp->GetIShapeAt(i);
-			TessellateShape(iShape);
+			TessellateShape(iShape, model->GetArena());
 		}
+
+		extractScope.Next();
 	}
 
 	comps.clear();
+
+	// Each post-processing pass runs to its end, cancellation is checked in between
+	Message_ProgressScope postScope(scope.Next(), "Post-processing", 3);
+
+	if (m_opt->GetNormals()
+		&& postScope.More())
+		ComputeNormals(model);
+	postScope.Next();
+
+	if (m_opt->GetVertexCache() > 0
+		&& postScope.More())
+		OptimizeMeshes(model);
+	postScope.Next();
+
+	if (m_opt->GetLodLevels() > 0
+		&& postScope.More())
+		GenerateLods(model);
+	postScope.Next();
+
+	return !scope.UserBreak();
+}
+
+bool Tessellator::MeshShape(const TopoDS_Shape& shape, const IMeshTools_Parameters& parameters, const Message_ProgressRange& range) const {
+	TraceScope trace("BRepMesh", "mesh");
+
+	if (IsMeshedByFace())
+		return TessellateFaces(shape, parameters, range);
+
+	// The budget breaks BRepMesh at its deadline or once the tessellation is cancelled
+	if (m_budget)
+		return OCCUtil::TessellateShape(shape, parameters, m_budget->GetModelRange());
+
+	return OCCUtil::TessellateShape(shape, parameters, range);
+}
+
+void Tessellator::TessellateGlobal(Model*& model, const Message_ProgressRange& range) const {
+	Message_ProgressScope scope(range, "Meshing", model->GetComponentSize());
+
+	for (int i = 0; i < model->GetComponentSize() && scope.More(); ++i) {
+		Component* rootComp = model->GetComponentAt(i);
+		TopoDS_Shape shape = GetUncachedShape(rootComp->GetShape());
+
+		if (shape.IsNull()) {
+			scope.Next();
+			continue;
+		}
+
+		// Tessellate and add mesh data of a shape
+		bool isDone = MeshShape(shape, GetSolidParameters(model, rootComp), scope.Next());
+
+		if (!isDone
+			&& !scope.UserBreak())
+			wcout << "\tTessellation has failed on Shape: " << rootComp->GetName() << endl;
+	}
+}
+
+void Tessellator::TessellateAdaptive(Model*& model, const Message_ProgressRange& range) const {
+	// Solids, and the faces outside of solids, are meshed one at a time with their own minimum size.
+	// Instances share one triangulation, so each solid and face is meshed and counted once.
+	vector<TopoDS_Shape> parts;
+	unordered_set<const TopoDS_TShape*> visited;
+	for (int i = 0; i < model->GetComponentSize(); ++i) {
+		const TopoDS_Shape& shape = model->GetComponentAt(i)->GetShape();
+
+		TopExp_Explorer ExpSolid;
+		for (ExpSolid.Init(shape, TopAbs_SOLID); ExpSolid.More(); ExpSolid.Next()) {
+			if (!visited.insert(ExpSolid.Current().TShape().get()).second)
+				continue;
+
+			if (!m_cache
+				|| !m_cache->IsCached(ExpSolid.Current()))
+				parts.push_back(ExpSolid.Current());
+		}
+
+		TopoDS_Compound freeFaces;
+		BRep_Builder builder;
+		builder.MakeCompound(freeFaces);
+
+		bool hasFreeFace = false;
+		TopExp_Explorer ExpFace;
+		for (ExpFace.Init(shape, TopAbs_FACE, TopAbs_SOLID); ExpFace.More(); ExpFace.Next()) {
+			if (!visited.insert(ExpFace.Current().TShape().get()).second)
+				continue;
+
+			builder.Add(freeFaces, ExpFace.Current());
+			hasFreeFace = true;
+		}
+
+		if (hasFreeFace)
+			parts.push_back(freeFaces);
+	}
+
+	vector<double> partSizes(parts.size(), 0.0);
+	OSD_Parallel::For(0, (int)parts.size(), [&parts, &partSizes](int i) {
+		Bnd_Box bndBox = OCCUtil::ComputeBoundingBox(parts[i]).FinitePart();
+
+		if (!bndBox.IsVoid())
+			partSizes[i] = sqrt(bndBox.SquareExtent());
+	});
+
+	int budget = m_opt->GetTriangleBudget();
+	double deflection = ADAPTIVE_DEFLECTION;
+	double prevDeflection = 0.0;
+	int prevTriangleCount = 0;
+
+	Message_ProgressScope scope(range, "Meshing", MAX_BUDGET_PASSES);
+	for (int pass = 0; pass < MAX_BUDGET_PASSES; ++pass) {
+		int triangleCount = 0;
+
+		Message_ProgressScope passScope(scope.Next(), "Meshing solids", (double)parts.size());
+		for (int i = 0; i < (int)parts.size(); ++i) {
+			if (!passScope.More())
+				return;
+
+			// Relative mode scales the deflection of every edge and face by its own size
+			IMeshTools_Parameters parameters = GetParameters(deflection, true);
+			parameters.MinSize = Max(deflection * partSizes[i] * MIN_SIZE_RATIO, Precision::Confusion());
+
+			bool isDone = MeshShape(parts[i], parameters, passScope.Next());
+
+			if (!isDone
+				&& !passScope.UserBreak())
+				cout << "\tTessellation has failed on solid " << i + 1 << " of " << parts.size() << endl;
+
+			triangleCount += OCCUtil::CountTriangles(parts[i]);
+		}
+
+		cout << "Adaptive deflection " << deflection << ": " << triangleCount << " triangles" << endl;
+
+		// Anything between half the budget and the budget is close enough
+		if (budget == 0
+			|| triangleCount == 0
+			|| (m_budget && m_budget->IsModelTimeOver())
+			|| (triangleCount <= budget && 2 * triangleCount >= budget))
+			break;
+
+		// Triangles grow like deflection^-e, e is 1 for doubly and 0.5 for singly curved faces
+		double exponent = 1.0;
+		if (pass > 0
+			&& triangleCount != prevTriangleCount)
+			exponent = Min(Max(log((double)prevTriangleCount / triangleCount) / log(deflection / prevDeflection), 0.25), 2.0);
+
+		double target = 0.75 * budget;
+		double nextDeflection = deflection * pow(triangleCount / target, 1.0 / exponent);
+		nextDeflection = Min(Max(nextDeflection, MIN_ADAPTIVE_DEFLECTION), MAX_ADAPTIVE_DEFLECTION);
+
+		if (nextDeflection == deflection)
+			break;
+
+		prevDeflection = deflection;
+		prevTriangleCount = triangleCount;
+		deflection = nextDeflection;
+	}
 }
 
-void Tessellator::TessellateShape(IShape*& iShape) const {
+bool Tessellator::IsMeshedByFace(void) const {
+	// Per-face costs and per-face time limits need the faces meshed one at a time
+	return m_report
+		|| (m_budget && m_opt->GetFaceTimeLimit() > 0.0);
+}
+
+IMeshTools_Parameters Tessellator::GetParameters(double linDeflection, bool isRelative) const {
+	IMeshTools_Parameters parameters;
+	parameters.Deflection = linDeflection;
+	parameters.Angle = m_angDeflection;
+	parameters.Relative = isRelative;
+	parameters.InParallel = true;
+
+	return parameters;
+}
+
+IMeshTools_Parameters Tessellator::GetSolidParameters(Model*& model, Component* rootComp) const {
+	// Without a budget the adaptive deflection stays at its first pass
+	if (m_opt->GetAdaptiveDeflection())
+		return GetParameters(ADAPTIVE_DEFLECTION, true);
+
+	return GetParameters(GetRootDeflection(model, rootComp), m_isRelative);
+}
+
+double Tessellator::GetRootDeflection(Model*& model, Component* rootComp) const {
+	// A shard only holds part of the root, its own box would give another deflection
+	const ShardInfo& shardInfo = model->GetShardInfo();
+	if (shardInfo.count > 1
+		&& shardInfo.deflection > 0.0)
+		return shardInfo.deflection;
+
+	// Get the relative linear deflection for a shape
+	return OCCUtil::GetDeflection(rootComp->GetBoundingBox(true));
+}
+
+bool Tessellator::TessellateFaces(const TopoDS_Shape& shape, const IMeshTools_Parameters& parameters, const Message_ProgressRange& range) const {
+	// Mesh face by face on one thread so that each face can be timed and limited
+	BRepTools::Clean(shape);
+
+	IMeshTools_Parameters faceParameters = parameters;
+	faceParameters.InParallel = false;
+
+	int faceCount = 0;
+	TopExp_Explorer ExpFace;
+	for (ExpFace.Init(shape, TopAbs_FACE); ExpFace.More(); ExpFace.Next())
+		faceCount++;
+
+	Message_ProgressScope scope(range, "Meshing faces", faceCount);
+
+	bool isDone = true;
+	int faceIndex = 0;
+	for (ExpFace.Init(shape, TopAbs_FACE); ExpFace.More(); ExpFace.Next(), ++faceIndex) {
+		const TopoDS_Face& face = TopoDS::Face(ExpFace.Current());
+
+		// Faces left at the deadline are meshed coarse by the budget
+		if (!scope.More()
+			|| (m_budget && m_budget->IsModelTimeOver())) {
+			isDone = false;
+			break;
+		}
+
+		TraceScope faceTrace("MeshFace", "mesh", "face", faceIndex);
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		if (m_budget) {
+			isDone &= m_budget->MeshFace(face, faceParameters);
+			scope.Next();
+		} else
+			isDone &= BRepMesh_IncrementalMesh(face, faceParameters, scope.Next()).IsDone();
+		double meshTime = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+		if (m_report)
+			m_report->AddMeshTime(face, meshTime);
+	}
+
+	return isDone;
+}
+
+void Tessellator::TessellateShape(IShape*& iShape, Arena& arena) const {
 	if (iShape->IsFaceSet())
-		AddMeshForFaceSet(iShape);
+		AddMeshForFaceSet(iShape, arena);
 	else
-		AddMeshForSketchGeometry(iShape);
+		AddMeshForSketchGeometry(iShape, arena);
 }
 
-void Tessellator::AddMeshForFaceSet(IShape*& iShape) const {
+void Tessellator::AddMeshForFaceSet(IShape*& iShape, Arena& arena) const {
 	const TopoDS_Shape& shape = iShape->GetShape();
+	TraceScope trace("ExtractMeshes", "extract", "shape", iShape->GetGlobalIndex());
 
 	TopExp_Explorer ExpEdge;
 	for (ExpEdge.Init(shape, TopAbs_EDGE); ExpEdge.More(); ExpEdge.Next()) {
 		const TopoDS_Edge& edge = TopoDS::Edge(ExpEdge.Current());
 
 	}
+	TopTools_DataMapOfShapeInteger meshIndexes;	// Face to its mesh, only for the cache
+
 	// Traverse faces
+	int faceCount = 0;
 	TopExp_Explorer ExpFace;
-	for (ExpFace.Init(shape, TopAbs_FACE); ExpFace.More(); ExpFace.Next()) {
+	for (ExpFace.Init(shape, TopAbs_FACE); ExpFace.More(); ExpFace.Next(), ++faceCount) {
 		const TopoDS_Face& face = TopoDS::Face(ExpFace.Current());
-		Mesh* mesh = GetMeshForFace(face);
+
+		chrono::steady_clock::time_point start = chrono::steady_clock::now();
+		Mesh* mesh = m_cache && m_cache->IsCached(face)
+			? m_cache->GetMeshForFace(face, arena)
+			: GetMeshForFace(face, arena);
+
+		if (m_report) {
+			double extractTime = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+			int triangleCount = mesh ? mesh->GetFaceIndexSize() : 0;
+			int nodeCount = mesh ? mesh->GetCoordinateSize() : 0;
+
+			m_report->AddFace(face, iShape->GetFaceStepID(face), extractTime, triangleCount, nodeCount);
+		}
+
+		if (mesh
+			&& m_budget
+			&& m_budget->IsDegraded(face))
+			mesh->SetDegraded(true);
 
 		// Save the faceMesh
-		if (mesh)
+		if (mesh) {
 			iShape->AddMesh(mesh);
+
+			if (m_cache)
+				meshIndexes.Bind(face, iShape->GetMeshSize() - 1);
+		}
 	}
-	GProp_GProps props;
-	BRepGProp::VolumeProperties(shape, props);
-	Standard_Real volume = props.Mass();
-	iShape->SetVolume(volume);
+	trace.SetArg("faces", faceCount);
+
+	ComputeMassProperties(iShape);
+
+	if (m_cache)
+		StoreCachedSolids(iShape, meshIndexes);
+
 	iShape->SetTessellated(true);
 }
 
-void Tessellator::AddMeshForSketchGeometry(IShape*& iShape) const {
+void Tessellator::ComputeMassProperties(IShape*& iShape) const {
+	const TopoDS_Shape& shape = iShape->GetShape();
+	double tolerance = m_opt->GetMassTolerance();
+	TraceScope trace("MassProperties", "mass", "shape", iShape->GetGlobalIndex());
+
+	vector<TopoDS_Shape> solids;
+	TopExp_Explorer ExpSolid;
+	for (ExpSolid.Init(shape, TopAbs_SOLID); ExpSolid.More(); ExpSolid.Next())
+		solids.push_back(ExpSolid.Current());
+
+	// One solid per task, cached solids are not integrated again
+	vector<MassProperties> solidProperties(solids.size());
+	OSD_Parallel::For(0, (int)solids.size(), [this, &solids, &solidProperties, tolerance](int i) {
+		TraceScope solidTrace("SolidMassProperties", "mass", "solid", i);
+
+		if (m_cache
+			&& m_cache->IsCached(solids[i]))
+			solidProperties[i] = m_cache->GetMassProperties(solids[i]);
+		else
+			solidProperties[i].Compute(solids[i], tolerance);
+	});
+
+	MassProperties massProperties;
+	for (const auto& properties : solidProperties) {
+		massProperties.Add(properties);
+		iShape->AddSolidProperties(properties);
+	}
+
+	// Faces outside of solids still count, as they did for the whole shape
+	TopoDS_Compound freeFaces;
+	BRep_Builder builder;
+	builder.MakeCompound(freeFaces);
+
+	bool hasFreeFace = false;
+	TopExp_Explorer ExpFace;
+	for (ExpFace.Init(shape, TopAbs_FACE, TopAbs_SOLID); ExpFace.More(); ExpFace.Next()) {
+		builder.Add(freeFaces, ExpFace.Current());
+		hasFreeFace = true;
+	}
+
+	if (hasFreeFace) {
+		MassProperties freeProperties;
+		freeProperties.Compute(freeFaces, tolerance);
+		massProperties.Add(freeProperties);
+	}
+
+	iShape->SetMassProperties(massProperties);
+
+	double volume = massProperties.GetVolume();
+	iShape->SetVolume(volume);
+}
+
+void Tessellator::LoadCachedSolids(Model*& model) const {
+	TraceScope trace("LoadCachedSolids", "cache");
+	vector<TopoDS_Shape> solids;
+	vector<int> rootIndexes;
+	for (int i = 0; i < model->GetComponentSize(); ++i) {
+		TopExp_Explorer ExpSolid;
+		for (ExpSolid.Init(model->GetComponentAt(i)->GetShape(), TopAbs_SOLID); ExpSolid.More(); ExpSolid.Next()) {
+			solids.push_back(ExpSolid.Current());
+			rootIndexes.push_back(i);
+		}
+	}
+
+	// Fingerprints only read the geometry, the entries are then looked up in order
+	vector<uint64_t> fingerprints(solids.size(), 0);
+	OSD_Parallel::For(0, (int)solids.size(), [&solids, &fingerprints](int i) {
+		fingerprints[i] = ShapeFingerprint::Compute(solids[i]);
+	});
+
+	for (int i = 0; i < (int)solids.size(); ++i)
+		m_cache->Load(solids[i], fingerprints[i], GetSolidParameters(model, model->GetComponentAt(rootIndexes[i])));
+}
+
+TopoDS_Shape Tessellator::GetUncachedShape(const TopoDS_Shape& shape) const {
+	if (!m_cache)
+		return shape;
+
+	TopoDS_Compound uncached;
+	BRep_Builder builder;
+	builder.MakeCompound(uncached);
+
+	bool hasCachedSolid = false;
+	bool isEmpty = true;
+	TopExp_Explorer ExpSolid;
+	for (ExpSolid.Init(shape, TopAbs_SOLID); ExpSolid.More(); ExpSolid.Next()) {
+		if (m_cache->IsCached(ExpSolid.Current())) {
+			hasCachedSolid = true;
+			continue;
+		}
+
+		builder.Add(uncached, ExpSolid.Current());
+		isEmpty = false;
+	}
+
+	if (!hasCachedSolid)
+		return shape;
+
+	TopExp_Explorer ExpFace;
+	for (ExpFace.Init(shape, TopAbs_FACE, TopAbs_SOLID); ExpFace.More(); ExpFace.Next()) {
+		builder.Add(uncached, ExpFace.Current());
+		isEmpty = false;
+	}
+
+	// Null once every face is cached
+	return isEmpty ? TopoDS_Shape() : uncached;
+}
+
+void Tessellator::StoreCachedSolids(IShape*& iShape, const TopTools_DataMapOfShapeInteger& meshIndexes) const {
+	// Solids are in the order of their mass properties
+	int solidIndex = 0;
+	TopExp_Explorer ExpSolid;
+	for (ExpSolid.Init(iShape->GetShape(), TopAbs_SOLID); ExpSolid.More(); ExpSolid.Next(), ++solidIndex) {
+		const TopoDS_Shape& solid = ExpSolid.Current();
+
+		if (!m_cache->IsPending(solid))
+			continue;
+
+		vector<Mesh*> faceMeshes;
+		TopExp_Explorer ExpFace;
+		for (ExpFace.Init(solid, TopAbs_FACE); ExpFace.More(); ExpFace.Next())
+			faceMeshes.push_back(meshIndexes.IsBound(ExpFace.Current()) ? iShape->GetMeshAt(meshIndexes.Find(ExpFace.Current())) : nullptr);
+
+		m_cache->Store(solid, iShape->GetSolidPropertiesAt(solidIndex), faceMeshes);
+	}
+}
+
+void Tessellator::AddMeshForSketchGeometry(IShape*& iShape, Arena& arena) const {
 	const TopoDS_Shape& shape = iShape->GetShape();
 
 	// Traverse edges
 	TopExp_Explorer ExpEdge;
 	for (ExpEdge.Init(shape, TopAbs_EDGE); ExpEdge.More(); ExpEdge.Next()) {
 		const TopoDS_Edge& edge = TopoDS::Edge(ExpEdge.Current());
-		Mesh* mesh = GetMeshForEdge(edge);
+		Mesh* mesh = GetMeshForEdge(edge, arena);
 
 		// Save the edgeMesh
 		if (mesh)
@@ -98,7 +576,7 @@ void Tessellator::AddMeshForSketchGeometry(IShape*& iShape) const {
 	iShape->SetTessellated(true);
 }
 
-Mesh* Tessellator::GetMeshForFace(const TopoDS_Face& face) const {
+Mesh* Tessellator::GetMeshForFace(const TopoDS_Face& face, Arena& arena) const {
 	TopLoc_Location loc;
 
 	const Handle(Poly_Triangulation)& myT = BRep_Tool::Triangulation(face, loc);
@@ -107,19 +585,18 @@ Mesh* Tessellator::GetMeshForFace(const TopoDS_Face& face) const {
 	if (!myT || myT.IsNull())
 		return nullptr;
 
-	Mesh* mesh = new Mesh(face);
+	Mesh* mesh = arena.New<Mesh>(face, &arena);
 
 	const Poly_ArrayOfNodes& Nodes = myT->InternalNodes();
-
-	// Add coordinates
-	for (int i = Nodes.Lower(); i <= Nodes.Upper(); ++i) {
-		const gp_Pnt& pnt = Nodes[i].Transformed(loc.Transformation());
-		mesh->AddCoordinate(pnt.XYZ());
-	}
-
 	const TopAbs_Orientation& orientation = face.Orientation();
 	const Poly_Array1OfTriangle& triangles = myT->InternalTriangles();
 
+	// Exact sizes, so the buffers are allocated once
+	mesh->Reserve(Nodes.Length(), myT->NbTriangles());
+
+	// Add coordinates, written straight into the mesh
+	OCCUtil::TransformNodes(Nodes, loc, mesh->AddCoordinates(Nodes.Length()));
+
 	// Add triangle indexes
 	for (int i = 1; i <= myT->NbTriangles(); ++i) {
 		int n1, n2, n3;
@@ -137,10 +614,16 @@ Mesh* Tessellator::GetMeshForFace(const TopoDS_Face& face) const {
 	double perimeterFace = 0.0;
 	// Add boundary edges
 	if (m_opt->GetEdge()) {
+		TraceScope perimeterTrace("Perimeter", "extract");
 		TopExp_Explorer ExpEdge;
 		for (ExpEdge.Init(face, TopAbs_EDGE); ExpEdge.More(); ExpEdge.Next()) {
 			const TopoDS_Edge& edge = TopoDS::Edge(ExpEdge.Current());
 			const Handle(Poly_PolygonOnTriangulation)& polygon = BRep_Tool::PolygonOnTriangulation(edge, myT, loc);
+
+			// Edges of a face meshed again on its own may keep the polygons of the former triangulation
+			if (polygon.IsNull())
+				continue;
+
 			const TColStd_Array1OfInteger& edgeNodes = polygon->Nodes();
 			vector<int> edgeIndex;
 			vector<double> edgePerimeter;
@@ -160,7 +643,7 @@ Mesh* Tessellator::GetMeshForFace(const TopoDS_Face& face) const {
 	return mesh;
 }
 
-Mesh* Tessellator::GetMeshForEdge(const TopoDS_Edge& edge) const {
+Mesh* Tessellator::GetMeshForEdge(const TopoDS_Edge& edge, Arena& arena) const {
 	TopLoc_Location loc;
 
 	// Get a tessellated edge
@@ -169,7 +652,7 @@ Mesh* Tessellator::GetMeshForEdge(const TopoDS_Edge& edge) const {
 	if (!myP || myP.IsNull())
 		return nullptr;
 
-	Mesh* mesh = new Mesh(edge);
+	Mesh* mesh = arena.New<Mesh>(edge, &arena);
 
 	const TColgp_Array1OfPnt& Nodes = myP->Nodes();
 
@@ -189,6 +672,210 @@ Mesh* Tessellator::GetMeshForEdge(const TopoDS_Edge& edge) const {
 	return mesh;
 }
 
+void Tessellator::ComputeNormals(Model*& model) const {
+	TraceScope trace("ComputeNormals", "post");
+	vector<Component*> comps;
+	model->GetAllComponents(comps);
+
+	vector<Mesh*> meshes;
+	for (const auto& comp : comps) {
+		for (int i = 0; i < comp->GetIShapeSize(); ++i) {
+			IShape* iShape = comp->GetIShapeAt(i);
+
+			if (!iShape->IsFaceSet())
+				continue;
+
+			for (int j = 0; j < iShape->GetMeshSize(); ++j)
+				meshes.push_back(iShape->GetMeshAt(j));
+		}
+	}
+
+	comps.clear();
+
+	OSD_Parallel::For(0, (int)meshes.size(), [this, &meshes](int i) {
+		AddNormalsForFace(meshes[i]);
+	});
+}
+
+void Tessellator::AddNormalsForFace(Mesh* mesh) const {
+	const TopoDS_Face& face = TopoDS::Face(mesh->GetShape());
+
+	TopLoc_Location loc;
+	const Handle(Poly_Triangulation)& myT = BRep_Tool::Triangulation(face, loc);
+
+	if (myT.IsNull()
+		|| myT->NbNodes() != mesh->GetCoordinateSize()) {
+		AddAveragedNormals(mesh);
+		return;
+	}
+
+	bool isReversed = face.Orientation() == TopAbs_REVERSED;
+
+	vector<gp_XYZ> normals;
+	normals.reserve(myT->NbNodes());
+
+	if (myT->HasNormals()) {
+		// Normals stored with the triangulation follow the surface, not the face
+		for (int i = 1; i <= myT->NbNodes(); ++i) {
+			gp_Dir normal = myT->Normal(i).Transformed(loc.Transformation());
+
+			if (isReversed)
+				normal.Reverse();
+
+			normals.push_back(normal.XYZ());
+		}
+	} else if (myT->HasUVNodes()) {
+		// Evaluated on the surface, already flipped for reversed faces
+		BRepGProp_Face prop(face);
+
+		for (int i = 1; i <= myT->NbNodes(); ++i) {
+			const gp_Pnt2d& uv = myT->UVNode(i);
+			gp_Pnt pnt;
+			gp_Vec normal;
+			prop.Normal(uv.X(), uv.Y(), pnt, normal);
+
+			// Singular points such as cone apexes have no surface normal
+			if (normal.SquareMagnitude() <= Precision::SquareConfusion()) {
+				AddAveragedNormals(mesh);
+				return;
+			}
+
+			normals.push_back(normal.Normalized().XYZ());
+		}
+	} else {
+		AddAveragedNormals(mesh);
+		return;
+	}
+
+	// One normal per node, so the normal indexes are the triangle indexes
+	mesh->ReserveNormals((int)normals.size(), mesh->GetFaceIndexSize());
+	for (const auto& normal : normals)
+		mesh->AddNormal(normal);
+
+	for (int i = 0; i < mesh->GetFaceIndexSize(); ++i) {
+		const Index& faceIndex = mesh->GetFaceIndexAt(i);
+		mesh->AddNormalIndex(faceIndex[0], faceIndex[1], faceIndex[2]);
+	}
+}
+
+void Tessellator::AddAveragedNormals(Mesh* mesh) const {
+	int nodeCount = mesh->GetCoordinateSize();
+	int triangleCount = mesh->GetFaceIndexSize();
+	double minCos = cos(m_opt->GetCreaseAngle());
+
+	// Area weighted triangle normals and the triangles around each node
+	vector<gp_XYZ> triangleNormals(triangleCount);
+	vector<gp_XYZ> triangleDirs(triangleCount);
+	vector<vector<int>> nodeTriangles(nodeCount);
+
+	for (int i = 0; i < triangleCount; ++i) {
+		const Index& faceIndex = mesh->GetFaceIndexAt(i);
+		const gp_XYZ& p1 = mesh->GetCoordinateAt(faceIndex[0] - 1);
+		const gp_XYZ& p2 = mesh->GetCoordinateAt(faceIndex[1] - 1);
+		const gp_XYZ& p3 = mesh->GetCoordinateAt(faceIndex[2] - 1);
+
+		// Degenerate triangles, more common once decimated, add nothing to their nodes
+		triangleNormals[i] = (p2 - p1).Crossed(p3 - p1);
+		double modulus = triangleNormals[i].Modulus();
+		triangleDirs[i] = modulus > Precision::Confusion() ? triangleNormals[i] / modulus : gp_XYZ(0.0, 0.0, 0.0);
+
+		for (int k = 0; k < 3; ++k)
+			nodeTriangles[faceIndex[k] - 1].push_back(i);
+	}
+
+	// Normals already written for each node, with their 1-based index
+	vector<vector<pair<gp_XYZ, int>>> nodeNormals(nodeCount);
+
+	// Collected first, so the arena buffers of the mesh are allocated once at their exact size
+	vector<gp_XYZ> normals;
+	vector<array<int, 3>> normalIndexes(triangleCount);
+
+	for (int i = 0; i < triangleCount; ++i) {
+		const Index& faceIndex = mesh->GetFaceIndexAt(i);
+		array<int, 3>& normalIndex = normalIndexes[i];
+		normalIndex.fill(0);
+
+		for (int k = 0; k < 3; ++k) {
+			int node = faceIndex[k] - 1;
+
+			// Smooth only with the triangles within the crease angle of this one
+			gp_XYZ normal(0.0, 0.0, 0.0);
+			for (int t : nodeTriangles[node]) {
+				if (triangleDirs[t].Dot(triangleDirs[i]) >= minCos)
+					normal += triangleNormals[t];
+			}
+
+			if (normal.Modulus() > Precision::Confusion())
+				normal.Normalize();
+
+			for (const auto& nodeNormal : nodeNormals[node]) {
+				if (nodeNormal.first.IsEqual(normal, Precision::Confusion())) {
+					normalIndex[k] = nodeNormal.second;
+					break;
+				}
+			}
+
+			if (normalIndex[k] == 0) {
+				normals.push_back(normal);
+				normalIndex[k] = (int)normals.size();
+				nodeNormals[node].push_back({ normal, normalIndex[k] });
+			}
+		}
+	}
+
+	mesh->ReserveNormals((int)normals.size(), triangleCount);
+	for (const auto& normal : normals)
+		mesh->AddNormal(normal);
+
+	for (const auto& normalIndex : normalIndexes)
+		mesh->AddNormalIndex(normalIndex[0], normalIndex[1], normalIndex[2]);
+}
+
+void Tessellator::OptimizeMeshes(Model*& model) const {
+	TraceScope trace("OptimizeMeshes", "post");
+	MeshOptimizer optimizer(m_opt->GetVertexCache());
+
+	vector<Component*> comps;
+	model->GetAllComponents(comps);
+
+	cout << "Vertex cache optimization (ACMR, cache size " << m_opt->GetVertexCache() << ")" << endl;
+
+	for (const auto& comp : comps) {
+		for (int i = 0; i < comp->GetIShapeSize(); ++i) {
+			IShape* iShape = comp->GetIShapeAt(i);
+
+			if (!iShape->IsFaceSet())
+				continue;
+
+			int meshSize = iShape->GetMeshSize();
+			vector<int> missesBefore(meshSize, 0);
+			vector<int> missesAfter(meshSize, 0);
+
+			OSD_Parallel::For(0, meshSize, [&](int j) {
+				Mesh* mesh = iShape->GetMeshAt(j);
+
+				missesBefore[j] = optimizer.CountCacheMisses(mesh);
+				optimizer.Optimize(mesh);
+				missesAfter[j] = optimizer.CountCacheMisses(mesh);
+			});
+
+			int triangleCount = 0;
+			for (int j = 0; j < meshSize; ++j)
+				triangleCount += iShape->GetMeshAt(j)->GetFaceIndexSize();
+
+			if (triangleCount == 0)
+				continue;
+
+			double acmrBefore = accumulate(missesBefore.begin(), missesBefore.end(), 0) / (double)triangleCount;
+			double acmrAfter = accumulate(missesAfter.begin(), missesAfter.end(), 0) / (double)triangleCount;
+
+			wcout << "\t" << iShape->GetName() << ": " << acmrBefore << " -> " << acmrAfter << endl;
+		}
+	}
+
+	comps.clear();
+}
+
 bool Tessellator::IsTriangleValid(const gp_Pnt& p1, const gp_Pnt& p2, const gp_Pnt& p3) const {
 	gp_Vec v1(p1, p2);
 	gp_Vec v2(p2, p3);
@@ -207,3 +894,74 @@ bool Tessellator::IsTriangleValid(const gp_Pnt& p1, const gp_Pnt& p2, const gp_P
 
 	return false;
 }
+
+
+void Tessellator::GenerateLods(Model*& model) const {
+	TraceScope trace("GenerateLods", "post");
+	int levelSize = m_opt->GetLodLevels();
+
+	vector<Component*> comps;
+	model->GetAllComponents(comps);
+
+	vector<IShape*> iShapes;
+	vector<pair<int, int>> tasks;	// IShape and mesh of each face
+	for (const auto& comp : comps) {
+		for (int i = 0; i < comp->GetIShapeSize(); ++i) {
+			IShape* iShape = comp->GetIShapeAt(i);
+
+			if (!iShape->IsFaceSet())
+				continue;
+
+			for (int j = 0; j < iShape->GetMeshSize(); ++j)
+				tasks.push_back(make_pair((int)iShapes.size(), j));
+
+			iShapes.push_back(iShape);
+		}
+	}
+
+	comps.clear();
+
+	// Each level is decimated from the previous one, results are attached once all tasks are done
+	vector<vector<Mesh*>> lodMeshes(tasks.size());
+	Arena& arena = model->GetArena();
+	OSD_Parallel::For(0, (int)tasks.size(), [&](int i) {
+		MeshDecimator decimator;
+		const Mesh* mesh = iShapes[tasks[i].first]->GetMeshAt(tasks[i].second);
+
+		for (int level = 0; level < levelSize; ++level) {
+			Mesh* lodMesh = decimator.Decimate(mesh, 0.5, arena);
+
+			// The decimated surface has no B-rep nodes, so its normals are averaged
+			if (m_opt->GetNormals())
+				AddAveragedNormals(lodMesh);
+
+			lodMeshes[i].push_back(lodMesh);
+			mesh = lodMesh;
+		}
+	});
+
+	cout << "Levels of detail (triangles)" << endl;
+
+	int task = 0;
+	for (const auto& iShape : iShapes) {
+		vector<int> triangleCounts(levelSize + 1, 0);
+		vector<vector<Mesh*>> levels(levelSize);
+
+		for (int j = 0; j < iShape->GetMeshSize(); ++j, ++task) {
+			triangleCounts[0] += iShape->GetMeshAt(j)->GetFaceIndexSize();
+
+			for (int level = 0; level < levelSize; ++level) {
+				levels[level].push_back(lodMeshes[task][level]);
+				triangleCounts[level + 1] += lodMeshes[task][level]->GetFaceIndexSize();
+			}
+		}
+
+		for (const auto& level : levels)
+			iShape->AddLod(level);
+
+		wcout << "\t" << iShape->GetName() << ": " << triangleCounts[0];
+		for (int level = 1; level <= levelSize; ++level)
+			wcout << " -> " << triangleCounts[level];
+		wcout << endl;
+	}
+}
\ No newline at end of file
@@ -3,6 +3,9 @@
 class Component;
 class Mesh;
 class IShape;
+class TessellationReport;
+class TessellationBudget;
+class MeshCache;
 
 class Tessellator
 {
@@ -10,17 +13,51 @@ public:
 	Tessellator(InputOptions* opt);
 	~Tessellator(void);
 
-	void Tessellate(Model*& model) const;
+	// False when cancelled through the progress range
+	bool Tessellate(Model*& model, const Message_ProgressRange& range = Message_ProgressRange()) const;
 
 protected:
-	void TessellateModel(Model*& model) const;
-	void TessellateShape(IShape*& iShape) const;
+	bool TessellateModel(Model*& model, const Message_ProgressRange& range) const;
+	bool MeshShape(const TopoDS_Shape& shape, const IMeshTools_Parameters& parameters, const Message_ProgressRange& range) const;
+	bool TessellateFaces(const TopoDS_Shape& shape, const IMeshTools_Parameters& parameters, const Message_ProgressRange& range) const;
+
+	// One deflection per root shape from its bounding box
+	void TessellateGlobal(Model*& model, const Message_ProgressRange& range) const;
+
+	// Size-relative deflection per solid and face, rescaled until the triangle budget is met
+	void TessellateAdaptive(Model*& model, const Message_ProgressRange& range) const;
+	IMeshTools_Parameters GetParameters(double linDeflection, bool isRelative) const;
+	IMeshTools_Parameters GetSolidParameters(Model*& model, Component* rootComp) const;
+
+	// Linear deflection of a root, taken from the whole shape for a shard
+	double GetRootDeflection(Model*& model, Component* rootComp) const;
+	bool IsMeshedByFace(void) const;
+	void TessellateShape(IShape*& iShape, Arena& arena) const;
 	
-	void AddMeshForFaceSet(IShape*& iShape) const;
-	void AddMeshForSketchGeometry(IShape*& iShape) const;
+	void AddMeshForFaceSet(IShape*& iShape, Arena& arena) const;
+
+	// Solids whose fingerprint and parameters match a cache entry are neither meshed nor measured again
+	void LoadCachedSolids(Model*& model) const;
+	TopoDS_Shape GetUncachedShape(const TopoDS_Shape& shape) const;
+	void StoreCachedSolids(IShape*& iShape, const TopTools_DataMapOfShapeInteger& meshIndexes) const;
+
+	// Volume, area, center of mass and inertia per solid, one solid per task, summed for the IShape
+	void ComputeMassProperties(IShape*& iShape) const;
+	void AddMeshForSketchGeometry(IShape*& iShape, Arena& arena) const;
 
-	Mesh* GetMeshForFace(const TopoDS_Face& face) const;
-	Mesh* GetMeshForEdge(const TopoDS_Edge& edge) const;
+	Mesh* GetMeshForFace(const TopoDS_Face& face, Arena& arena) const;
+	Mesh* GetMeshForEdge(const TopoDS_Edge& edge, Arena& arena) const;
+
+	// Vertex normals of the face meshes, one face per task
+	void ComputeNormals(Model*& model) const;
+	void AddNormalsForFace(Mesh* mesh) const;
+	void AddAveragedNormals(Mesh* mesh) const;
+
+	// Triangle order for the GPU vertex cache, reporting the ACMR of each IShape
+	void OptimizeMeshes(Model*& model) const;
+
+	// Levels of detail of the face meshes by quadric edge collapse, one face per task
+	void GenerateLods(Model*& model) const;
 
 	bool IsTriangleValid(const gp_Pnt& p1, const gp_Pnt& p2, const gp_Pnt& p3) const;
 
@@ -31,4 +68,8 @@ private:
 	double m_angDeflection;
 
 	bool m_isRelative;
+
+	TessellationReport* m_report;	// Per-face costs, only with the face report option
+	TessellationBudget* m_budget;	// Triangle and time limits, only when one is set
+	MeshCache* m_cache;				// Meshes of unchanged solids, only with a cache directory and no limits
 };
\ No newline at end of file
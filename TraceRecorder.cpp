@@ -0,0 +1,100 @@
+#include "CommonImport.h"
+#include "TraceRecorder.h"
+#include <fstream>
+#include <set>
+
+atomic<bool> TraceRecorder::s_isEnabled(false);
+
+TraceRecorder::TraceRecorder(void) {}
+
+TraceRecorder& TraceRecorder::Instance(void) {
+	static TraceRecorder recorder;
+	return recorder;
+}
+
+int TraceRecorder::GetThreadID(void) {
+	static atomic<int> nextThreadID(1);
+	thread_local int threadID = nextThreadID++;
+	return threadID;
+}
+
+void TraceRecorder::Start(void) {
+	lock_guard<mutex> lock(m_mutex);
+	m_events.clear();
+	m_startTime = chrono::steady_clock::now();
+	s_isEnabled = true;
+
+	// The starting thread takes the first row
+	GetThreadID();
+}
+
+void TraceRecorder::AddEvent(const char* name, const char* category, chrono::steady_clock::time_point begin, chrono::steady_clock::time_point end,
+							 const char* const argNames[2], const long long argValues[2], int argCount) {
+	TraceEvent event;
+	event.name = name;
+	event.category = category;
+	event.threadID = GetThreadID();
+	event.argCount = argCount;
+	for (int i = 0; i < argCount; ++i) {
+		event.argNames[i] = argNames[i];
+		event.argValues[i] = argValues[i];
+	}
+
+	lock_guard<mutex> lock(m_mutex);
+	event.beginTime = chrono::duration_cast<chrono::microseconds>(begin - m_startTime).count();
+	event.duration = chrono::duration_cast<chrono::microseconds>(end - begin).count();
+	m_events.push_back(event);
+}
+
+bool TraceRecorder::Write(const filesystem::path& filePath) {
+	s_isEnabled = false;
+
+	lock_guard<mutex> lock(m_mutex);
+
+	ofstream ofs(filePath);
+	if (!ofs.is_open()) {
+		wcout << "Cannot write trace: " << filePath.wstring() << endl;
+		return false;
+	}
+
+	// Names and categories are literals without characters to escape
+	ofs << "{\"traceEvents\":[";
+
+	set<int> threadIDs;
+	bool isFirst = true;
+	for (const auto& event : m_events) {
+		ofs << (isFirst ? "\n" : ",\n");
+		isFirst = false;
+
+		ofs << "{\"name\":\"" << event.name << "\",\"cat\":\"" << event.category << "\",\"ph\":\"X\""
+			<< ",\"ts\":" << event.beginTime << ",\"dur\":" << event.duration
+			<< ",\"pid\":1,\"tid\":" << event.threadID;
+
+		if (event.argCount > 0) {
+			ofs << ",\"args\":{";
+			for (int i = 0; i < event.argCount; ++i)
+				ofs << (i > 0 ? "," : "") << "\"" << event.argNames[i] << "\":" << event.argValues[i];
+			ofs << "}";
+		}
+		ofs << "}";
+
+		threadIDs.insert(event.threadID);
+	}
+
+	// Name the rows, the first thread to record is the main one
+	for (int threadID : threadIDs) {
+		ofs << (isFirst ? "\n" : ",\n");
+		isFirst = false;
+
+		ofs << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << threadID
+			<< ",\"args\":{\"name\":\"" << (threadID == 1 ? "main" : "worker " + to_string(threadID)) << "\"}}";
+	}
+
+	ofs << "\n],\"displayTimeUnit\":\"ms\"}";
+	ofs.close();
+
+	cout << "\tTrace: " << m_events.size() << " events" << endl;
+	m_events.clear();
+
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,92 @@
+#pragma once
+
+#include <mutex>
+
+// Records the time spans of the pipeline stages as Chrome trace events, viewable in Perfetto or chrome://tracing.
+// Disabled by default, a span then costs one atomic load.
+class TraceRecorder {
+public:
+	static TraceRecorder& Instance(void);
+
+	static bool IsEnabled(void) { return s_isEnabled.load(memory_order_relaxed); }
+
+	// Drop the recorded events and take the time origin
+	void Start(void);
+
+	// Stop recording and write the events, false if the file cannot be written
+	bool Write(const filesystem::path& filePath);
+
+	void AddEvent(const char* name, const char* category, chrono::steady_clock::time_point begin, chrono::steady_clock::time_point end,
+				  const char* const argNames[2], const long long argValues[2], int argCount);
+
+	// Small per-thread number, shown as the trace row
+	static int GetThreadID(void);
+
+protected:
+	TraceRecorder(void);
+
+private:
+	struct TraceEvent {
+		const char* name;
+		const char* category;
+		long long beginTime;	// Microseconds since Start
+		long long duration;
+		int threadID;
+		const char* argNames[2];
+		long long argValues[2];
+		int argCount;
+	};
+
+	static atomic<bool> s_isEnabled;
+
+	chrono::steady_clock::time_point m_startTime;
+
+	mutex m_mutex;
+	vector<TraceEvent> m_events;
+};
+
+// Records one complete event from construction to destruction. Names are string literals.
+class TraceScope {
+public:
+	TraceScope(const char* name, const char* category)
+		: m_isActive(TraceRecorder::IsEnabled()),
+		m_name(name),
+		m_category(category),
+		m_argCount(0) {
+		if (m_isActive)
+			m_begin = chrono::steady_clock::now();
+	}
+
+	TraceScope(const char* name, const char* category, const char* argName, long long argValue)
+		: TraceScope(name, category) {
+		SetArg(argName, argValue);
+	}
+
+	~TraceScope(void) {
+		if (m_isActive)
+			TraceRecorder::Instance().AddEvent(m_name, m_category, m_begin, chrono::steady_clock::now(), m_argNames, m_argValues, m_argCount);
+	}
+
+	TraceScope(const TraceScope&) = delete;
+	TraceScope& operator=(const TraceScope&) = delete;
+
+	// Up to two arguments, such as a face or shape ID
+	void SetArg(const char* argName, long long argValue) {
+		if (!m_isActive
+			|| m_argCount >= 2)
+			return;
+
+		m_argNames[m_argCount] = argName;
+		m_argValues[m_argCount] = argValue;
+		m_argCount++;
+	}
+
+private:
+	bool m_isActive;
+	const char* m_name;
+	const char* m_category;
+	chrono::steady_clock::time_point m_begin;
+	const char* m_argNames[2];
+	long long m_argValues[2];
+	int m_argCount;
+};
\ No newline at end of file
@@ -0,0 +1,228 @@
+
+#include "CommonImport.h"
+#include "JsonWriter.h"
+#include "X3D_Writer.h"
+#include "Component.h"
+#include "IShape.h"
+#include "Mesh.h"
+#include <chrono>
+#include <random>
+//-----------------------------------------------------------------------------
+
+typedef chrono::steady_clock BenchClock;
+
+// Timings of the serialization hot paths on in-memory meshes
+class WriterBenchmark {
+public:
+	WriterBenchmark(int meshCount, int gridSize, int repeat);
+	~WriterBenchmark(void);
+
+	void Run(void);
+
+protected:
+	void BuildMeshes(void);
+
+	void RunDoubleToString(void) const;
+	void RunJsonWriteMesh(void);
+	void RunX3DWriteCoordinate(void);
+	void RunX3DWriteCoordinateIndex(void);
+
+	// Best time over the repetitions, in seconds
+	double Measure(const function<size_t(void)>& func, size_t& outputSize) const;
+	void Report(const string& name, double seconds, double count, const string& unit, size_t outputSize) const;
+
+private:
+	int m_meshCount;	// Face meshes in the IShape
+	int m_gridSize;		// Nodes per side of a face mesh
+	int m_repeat;
+
+	int m_vertexCount;
+	int m_indexCount;
+
+	InputOptions m_opt;
+	Model m_model;
+	IShape* m_iShape;
+};
+
+WriterBenchmark::WriterBenchmark(int meshCount, int gridSize, int repeat)
+	: m_meshCount(meshCount),
+	m_gridSize(gridSize),
+	m_repeat(repeat),
+	m_vertexCount(0),
+	m_indexCount(0),
+	m_iShape(nullptr) {
+	BuildMeshes();
+}
+
+WriterBenchmark::~WriterBenchmark(void) {}
+
+void WriterBenchmark::BuildMeshes(void) {
+	Component* comp = m_model.NewComponent(TopoDS_Shape());
+	m_iShape = m_model.NewIShape(TopoDS_Shape());
+	comp->AddIShape(m_iShape);
+	m_model.AddComponent(comp);
+
+	Arena& arena = m_model.GetArena();
+
+	mt19937 random(42);
+	uniform_real_distribution<double> noise(-0.5, 0.5);
+
+	for (int m = 0; m < m_meshCount; ++m) {
+		Mesh* mesh = arena.New<Mesh>(TopoDS_Face(), &arena);
+		double offset = m * 100.0;
+
+		// Slightly noisy grid so the coordinates need all printed digits
+		for (int i = 0; i < m_gridSize; ++i) {
+			for (int j = 0; j < m_gridSize; ++j) {
+				gp_XYZ coord(offset + i * 1.25 + noise(random), j * 1.25 + noise(random), noise(random));
+				mesh->AddCoordinate(coord);
+			}
+		}
+
+		// Two triangles per grid cell, 1-based like Poly_Triangulation
+		for (int i = 0; i < m_gridSize - 1; ++i) {
+			for (int j = 0; j < m_gridSize - 1; ++j) {
+				int n1 = i * m_gridSize + j + 1;
+				int n2 = n1 + 1;
+				int n3 = n1 + m_gridSize;
+				int n4 = n3 + 1;
+
+				mesh->AddFaceIndex(n1, n2, n4);
+				mesh->AddFaceIndex(n1, n4, n3);
+			}
+		}
+
+		// Boundary loop
+		vector<int> edgeIndex;
+		for (int j = 0; j < m_gridSize; ++j)
+			edgeIndex.push_back(j + 1);
+		for (int i = 1; i < m_gridSize; ++i)
+			edgeIndex.push_back(i * m_gridSize + m_gridSize);
+		for (int j = m_gridSize - 2; j >= 0; --j)
+			edgeIndex.push_back((m_gridSize - 1) * m_gridSize + j + 1);
+		for (int i = m_gridSize - 2; i >= 0; --i)
+			edgeIndex.push_back(i * m_gridSize + 1);
+		mesh->AddEdgeIndex(edgeIndex);
+
+		m_vertexCount += mesh->GetCoordinateSize();
+		m_indexCount += mesh->GetFaceIndexSize() * 3;
+
+		m_iShape->AddMesh(mesh);
+	}
+
+	cout << "Meshes: " << m_meshCount << ", vertices: " << m_vertexCount << ", triangle indexes: " << m_indexCount << endl << endl;
+}
+
+void WriterBenchmark::Run(void) {
+	RunDoubleToString();
+	RunJsonWriteMesh();
+	RunX3DWriteCoordinate();
+	RunX3DWriteCoordinateIndex();
+}
+
+void WriterBenchmark::RunDoubleToString(void) const {
+	vector<double> values;
+	values.reserve(m_vertexCount);
+
+	for (int i = 0; i < m_iShape->GetMeshSize(); ++i) {
+		Mesh* mesh = m_iShape->GetMeshAt(i);
+
+		for (int j = 0; j < mesh->GetCoordinateSize(); ++j)
+			values.push_back(mesh->GetCoordinateAt(j).X());
+	}
+
+	size_t outputSize = 0;
+	double seconds = Measure([&values]() {
+		size_t size = 0;
+		for (double val : values)
+			size += NumTool::DoubleToString(val).size();
+		return size;
+	}, outputSize);
+
+	Report("NumTool::DoubleToString", seconds, (double)values.size(), "call", outputSize);
+}
+
+void WriterBenchmark::RunJsonWriteMesh(void) {
+	JsonWriter jw(&m_opt);
+
+	size_t outputSize = 0;
+	double seconds = Measure([this, &jw]() {
+		json meshJson = jw.WriteMesh(m_iShape);
+		return meshJson.dump().size();
+	}, outputSize);
+
+	Report("JsonWriter::WriteMesh", seconds, m_vertexCount, "vertex", outputSize);
+}
+
+void WriterBenchmark::RunX3DWriteCoordinate(void) {
+	X3D_Writer xw(&m_opt);
+
+	size_t outputSize = 0;
+	double seconds = Measure([this, &xw]() {
+		return xw.WriteCoordinate(m_iShape, false).size();
+	}, outputSize);
+
+	Report("X3D_Writer::WriteCoordinate", seconds, m_vertexCount, "vertex", outputSize);
+}
+
+void WriterBenchmark::RunX3DWriteCoordinateIndex(void) {
+	X3D_Writer xw(&m_opt);
+
+	size_t outputSize = 0;
+	double seconds = Measure([this, &xw]() {
+		return xw.WriteCoordinateIndex(m_iShape, true).size();
+	}, outputSize);
+
+	Report("X3D_Writer::WriteCoordinateIndex", seconds, m_indexCount, "index", outputSize);
+}
+
+double WriterBenchmark::Measure(const function<size_t(void)>& func, size_t& outputSize) const {
+	double bestTime = numeric_limits<double>::max();
+
+	for (int i = 0; i < m_repeat; ++i) {
+		BenchClock::time_point start = BenchClock::now();
+		outputSize = func();
+		double seconds = chrono::duration<double>(BenchClock::now() - start).count();
+
+		bestTime = min(bestTime, seconds);
+	}
+
+	return bestTime;
+}
+
+void WriterBenchmark::Report(const string& name, double seconds, double count, const string& unit, size_t outputSize) const {
+	double nsPerUnit = seconds * 1.e9 / count;
+	double mbPerSecond = outputSize / (1024.0 * 1024.0) / seconds;
+
+	cout << name << endl;
+	cout << "\t" << seconds * 1.e3 << " ms, " << nsPerUnit << " ns/" << unit << ", " << mbPerSecond << " MB/s (" << outputSize << " chars)" << endl << endl;
+}
+
+int main(int argc, char** argv) {
+	int meshCount = 2000;
+	int gridSize = 12;
+	int repeat = 5;
+
+	// Set options
+	for (int i = 1; i + 1 < argc; i += 2) {
+		string token(argv[i]);
+		string value(argv[i + 1]);
+
+		if (token == "--meshes")
+			meshCount = max(1, stoi(value));
+		else if (token == "--grid")
+			gridSize = max(2, stoi(value));
+		else if (token == "--repeat")
+			repeat = max(1, stoi(value));
+		else {
+			cout << "No such option: " << token << endl;
+			cout << "Options: --meshes N (default 2000) --grid N (default 12) --repeat N (default 5)" << endl;
+			return -1;
+		}
+	}
+
+	WriterBenchmark bench(meshCount, gridSize, repeat);
+	bench.Run();
+
+	return 0;
+}
@@ -334,12 +334,23 @@ wstring X3D_Writer::WriteIndexedFaceSet(IShape*& iShape, int level) {
 
 	ss_ifs << WriteCoordinateIndex(iShape, true);
 
+	bool hasNormals = iShape->HasNormals();
+
+	if (hasNormals)
+		ss_ifs << WriteNormalIndex(iShape);
+
 	ss_ifs << ">\n";
 
 	// Write coordinates
 	ss_ifs << Indent(level + 1);
 	ss_ifs << WriteCoordinate(iShape, false);
 
+	// Write normals
+	if (hasNormals) {
+		ss_ifs << Indent(level + 1);
+		ss_ifs << WriteNormal(iShape);
+	}
+
 	// Close IndexedFaceSet
 	ss_ifs << Indent(level);
 	ss_ifs << "</IndexedFaceSet>\n";
@@ -523,7 +534,7 @@ wstring X3D_Writer::WriteCoordinateIndex(IShape*& iShape, bool faceMesh) const {
 		{
 			// Traverse triangles
 			for (int j = 0; j < mesh->GetFaceIndexSize(); ++j) {
-				const vector<int>& faceIndex = mesh->GetFaceIndexAt(j);
+				const Index& faceIndex = mesh->GetFaceIndexAt(j);
 
 				ss_coordIndex << to_wstring(faceIndex[0] - 1 + prevCoordCount) << " ";
 				ss_coordIndex << to_wstring(faceIndex[1] - 1 + prevCoordCount) << " ";
@@ -534,7 +545,7 @@ wstring X3D_Writer::WriteCoordinateIndex(IShape*& iShape, bool faceMesh) const {
 
 			// Traverse edges
 			for (int j = 0; j < mesh->GetEdgeIndexSize(); ++j) {
-				const vector<int>& edgeIndex = mesh->GetEdgeIndexAt(j);
+				const Index& edgeIndex = mesh->GetEdgeIndexAt(j);
 
 				for (size_t k = 0; k < edgeIndex.size(); ++k) {
 					int index = edgeIndex[k] - 1 + prevCoordCount;
@@ -558,22 +569,22 @@ wstring X3D_Writer::WriteNormalIndex(IShape*& iShape) const {
 	wstringstream ss_normalIndex;
 	ss_normalIndex << " normalIndex='";
 
-	int prevCoordCount = 0; // The number of previous coordinates
+	int prevNormalCount = 0; // The number of previous normals
 
 	for (int i = 0; i < iShape->GetMeshSize(); ++i) {
 		Mesh* mesh = iShape->GetMeshAt(i);
 
 		// Traverse triangles
 		for (int j = 0; j < mesh->GetNormalIndexSize(); ++j) {
-			const vector<int>& normalIndex = mesh->GetNormalIndexAt(j);
+			const Index& normalIndex = mesh->GetNormalIndexAt(j);
 
-			ss_normalIndex << to_wstring(normalIndex[0] - 1 + prevCoordCount) << " ";
-			ss_normalIndex << to_wstring(normalIndex[1] - 1 + prevCoordCount) << " ";
-			ss_normalIndex << to_wstring(normalIndex[2] - 1 + prevCoordCount) << " ";
+			ss_normalIndex << to_wstring(normalIndex[0] - 1 + prevNormalCount) << " ";
+			ss_normalIndex << to_wstring(normalIndex[1] - 1 + prevNormalCount) << " ";
+			ss_normalIndex << to_wstring(normalIndex[2] - 1 + prevNormalCount) << " ";
 			ss_normalIndex << "-1 ";
 		}
 
-		prevCoordCount += mesh->GetCoordinateSize();
+		prevNormalCount += mesh->GetNormalSize();
 	}
 
 	ss_normalIndex << "'";
@@ -650,34 +661,7 @@ bool X3D_Writer::CheckSameAppearance(const Quantity_Color& diffuseColor, bool is
 									 double& ambientIntensity, bool isAmbientIntensityOn,
 									 double& transparency, bool isTransparencyOn,
 									 int& appID) {
-	// Search for the same appearance
-	for (int i = 0; i < (int)m_appearances.size(); ++i) {
-		Appearance app = m_appearances[i];
-
-		if (app.isDiffuseOn == isDiffuseOn
-			&& ((isDiffuseOn && app.diffuseColor.IsEqual(diffuseColor))
-				|| !isDiffuseOn) &&
-			app.isEmissiveOn == isEmissiveOn
-			&& ((isEmissiveOn && app.emissiveColor.IsEqual(emissiveColor))
-				|| !isEmissiveOn) &&
-			app.isSpecularOn == isSpecularOn
-			&& ((isSpecularOn && app.specularColor.IsEqual(specularColor))
-				|| !isSpecularOn) &&
-			app.isShininessOn == isShininessOn
-			&& ((isShininessOn && abs(app.shininess - shininess) <= Precision::Confusion())
-				|| !isShininessOn) &&
-			app.isAmbientIntensityOn == isAmbientIntensityOn
-			&& ((isAmbientIntensityOn && abs(app.ambientIntensity - ambientIntensity) <= Precision::Confusion())
-				|| !isAmbientIntensityOn) &&
-			app.isTransparencyOn == isTransparencyOn
-			&& ((isTransparencyOn && abs(app.transparency - transparency) <= Precision::Confusion())
-				|| !isTransparencyOn)) {
-			appID = i; // Save the order
-			return true;
-		}
-	}
-
-	// Save the current appearance
+	// Look up the quantized appearance
 	Appearance app;
 	app.diffuseColor = diffuseColor;
 	app.emissiveColor = emissiveColor;
@@ -691,12 +675,8 @@ bool X3D_Writer::CheckSameAppearance(const Quantity_Color& diffuseColor, bool is
 	app.isShininessOn = isShininessOn;
 	app.isAmbientIntensityOn = isAmbientIntensityOn;
 	app.isTransparencyOn = isTransparencyOn;
-	m_appearances.push_back(app);
-
-	// Save the latest order
-	appID = (int)m_appearances.size() - 1;
 
-	return false;
+	return m_appRegistry.Register(app, appID);
 }
 
 wstring X3D_Writer::WriteSketchGeometry(IShape*& iShape, int level) {
@@ -783,10 +763,10 @@ void X3D_Writer::PrintIndentCount(void) {
 }
 
 void X3D_Writer::PrintMaterialCount(void) const {
-	printf("Number of Materials: %d\n", (int)m_appearances.size());
+	printf("Number of Materials: %d\n", m_appRegistry.GetAppearanceSize());
 }
 
 void X3D_Writer::Clear(void) {
-	m_appearances.clear();
+	m_appRegistry.Clear();
 	m_indentCountMap.clear();
 }
@@ -1,27 +1,15 @@
 #pragma once
 
+#include "AppearanceRegistry.h"
+
 class Component;
 class IShape;
-
-struct Appearance
-{
-	Quantity_Color diffuseColor;
-	Quantity_Color specularColor;
-	Quantity_Color emissiveColor;
-	double shininess = 0.0;
-	double ambientIntensity = 0.0;
-	double transparency = 0.0;
-
-	bool isDiffuseOn = false;
-	bool isEmissiveOn = false;
-	bool isSpecularOn = false;
-	bool isShininessOn = false;
-	bool isAmbientIntensityOn = false;
-	bool isTransparencyOn = false;
-};
+class WriterBenchmark;
 
 class X3D_Writer
 {
+	friend class WriterBenchmark;	// Times the serialization paths directly
+
 public:
 	X3D_Writer(InputOptions* opt);
 	~X3D_Writer(void);
@@ -87,7 +75,7 @@ private:
 
 	double m_creaseAngle;
 
-	vector<Appearance> m_appearances;
+	AppearanceRegistry m_appRegistry;
 	
 	// SFA-specific variables
 	map<int, int> m_indentCountMap;